@@ -7,6 +7,34 @@
 //#include <std>
 
 const LLVMIntrinsicID LLVMIntrinsicIDTrap = llvm::Intrinsic::trap;
+const LLVMIntrinsicID LLVMIntrinsicIDBswap = llvm::Intrinsic::bswap;
+const LLVMIntrinsicID LLVMIntrinsicIDCtpop = llvm::Intrinsic::ctpop;
+const LLVMIntrinsicID LLVMIntrinsicIDCttz = llvm::Intrinsic::cttz;
+const LLVMIntrinsicID LLVMIntrinsicIDCtlz = llvm::Intrinsic::ctlz;
+const LLVMIntrinsicID LLVMIntrinsicIDFshl = llvm::Intrinsic::fshl;
+const LLVMIntrinsicID LLVMIntrinsicIDFshr = llvm::Intrinsic::fshr;
+const LLVMIntrinsicID LLVMIntrinsicIDPrefetch = llvm::Intrinsic::prefetch;
+const LLVMIntrinsicID LLVMIntrinsicIDExpect = llvm::Intrinsic::expect;
+const LLVMIntrinsicID LLVMIntrinsicIDAssume = llvm::Intrinsic::assume;
+const LLVMIntrinsicID LLVMIntrinsicIDSaddWithOverflow = llvm::Intrinsic::sadd_with_overflow;
+const LLVMIntrinsicID LLVMIntrinsicIDUaddWithOverflow = llvm::Intrinsic::uadd_with_overflow;
+const LLVMIntrinsicID LLVMIntrinsicIDSsubWithOverflow = llvm::Intrinsic::ssub_with_overflow;
+const LLVMIntrinsicID LLVMIntrinsicIDUsubWithOverflow = llvm::Intrinsic::usub_with_overflow;
+const LLVMIntrinsicID LLVMIntrinsicIDSmulWithOverflow = llvm::Intrinsic::smul_with_overflow;
+const LLVMIntrinsicID LLVMIntrinsicIDUmulWithOverflow = llvm::Intrinsic::umul_with_overflow;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceAdd = llvm::Intrinsic::vector_reduce_add;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceMul = llvm::Intrinsic::vector_reduce_mul;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceAnd = llvm::Intrinsic::vector_reduce_and;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceOr = llvm::Intrinsic::vector_reduce_or;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceXor = llvm::Intrinsic::vector_reduce_xor;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceSMin = llvm::Intrinsic::vector_reduce_smin;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceSMax = llvm::Intrinsic::vector_reduce_smax;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceUMin = llvm::Intrinsic::vector_reduce_umin;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceUMax = llvm::Intrinsic::vector_reduce_umax;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceFAdd = llvm::Intrinsic::vector_reduce_fadd;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceFMul = llvm::Intrinsic::vector_reduce_fmul;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceFMin = llvm::Intrinsic::vector_reduce_fmin;
+const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceFMax = llvm::Intrinsic::vector_reduce_fmax;
 
 /*
  * The Tys parameter is for intrinsics with overloaded types (e.g., those using iAny, fAny, vAny, or iPTRAny).
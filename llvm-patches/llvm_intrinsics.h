@@ -7,6 +7,34 @@ extern "C" {
 
 typedef unsigned int LLVMIntrinsicID;
 extern const LLVMIntrinsicID LLVMIntrinsicIDTrap;
+extern const LLVMIntrinsicID LLVMIntrinsicIDBswap;
+extern const LLVMIntrinsicID LLVMIntrinsicIDCtpop;
+extern const LLVMIntrinsicID LLVMIntrinsicIDCttz;
+extern const LLVMIntrinsicID LLVMIntrinsicIDCtlz;
+extern const LLVMIntrinsicID LLVMIntrinsicIDFshl;
+extern const LLVMIntrinsicID LLVMIntrinsicIDFshr;
+extern const LLVMIntrinsicID LLVMIntrinsicIDPrefetch;
+extern const LLVMIntrinsicID LLVMIntrinsicIDExpect;
+extern const LLVMIntrinsicID LLVMIntrinsicIDAssume;
+extern const LLVMIntrinsicID LLVMIntrinsicIDSaddWithOverflow;
+extern const LLVMIntrinsicID LLVMIntrinsicIDUaddWithOverflow;
+extern const LLVMIntrinsicID LLVMIntrinsicIDSsubWithOverflow;
+extern const LLVMIntrinsicID LLVMIntrinsicIDUsubWithOverflow;
+extern const LLVMIntrinsicID LLVMIntrinsicIDSmulWithOverflow;
+extern const LLVMIntrinsicID LLVMIntrinsicIDUmulWithOverflow;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceAdd;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceMul;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceAnd;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceOr;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceXor;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceSMin;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceSMax;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceUMin;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceUMax;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceFAdd;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceFMul;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceFMin;
+extern const LLVMIntrinsicID LLVMIntrinsicIDVectorReduceFMax;
 LLVMValueRef LLVMGetIntrinsicByID(LLVMModuleRef mod, LLVMIntrinsicID id, LLVMTypeRef* tys, int nty);
 
 #ifdef __cplusplus
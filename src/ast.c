@@ -28,6 +28,25 @@ const char *binary_op_names[] = {
 	[AST_OR] = "||",
 };
 
+const struct intrinsic_info intrinsic_ops[AST_NUM_INTRINSICS] = {
+	[AST_INTRINSIC_CTPOP]        = { "ctpop",        1, 1 },
+	[AST_INTRINSIC_CTTZ]         = { "cttz",         1, 1 },
+	[AST_INTRINSIC_CTLZ]         = { "ctlz",         1, 1 },
+	[AST_INTRINSIC_BSWAP]        = { "bswap",        1, 1 },
+	[AST_INTRINSIC_FSHL]         = { "fshl",         3, 3 },
+	[AST_INTRINSIC_FSHR]         = { "fshr",         3, 3 },
+	[AST_INTRINSIC_ROTL]         = { "rotl",         2, 2 },
+	[AST_INTRINSIC_ROTR]         = { "rotr",         2, 2 },
+	[AST_INTRINSIC_PREFETCH]     = { "prefetch",     1, 3 },
+	[AST_INTRINSIC_EXPECT]       = { "expect",       2, 2 },
+	[AST_INTRINSIC_LIKELY]       = { "likely",       1, 1 },
+	[AST_INTRINSIC_UNLIKELY]     = { "unlikely",     1, 1 },
+	[AST_INTRINSIC_ASSUME]       = { "assume",       1, 1 },
+	[AST_INTRINSIC_ADD_OVERFLOW] = { "add_overflow", 3, 3 },
+	[AST_INTRINSIC_SUB_OVERFLOW] = { "sub_overflow", 3, 3 },
+	[AST_INTRINSIC_MUL_OVERFLOW] = { "mul_overflow", 3, 3 },
+};
+
 
 void
 expr_dispose (expr_t *self) {
@@ -37,6 +56,7 @@ expr_dispose (expr_t *self) {
 	unsigned i;
 	switch (self->kind) {
 		case AST_IDENT_EXPR:
+		case AST_LABEL_ADDR_EXPR:
 			free(self->ident);
 			break;
 		case AST_STRING_LITERAL_EXPR:
@@ -93,11 +113,21 @@ expr_dispose (expr_t *self) {
 			break;
 		case AST_NEW_BUILTIN:
 			type_dispose(&self->newe.type);
+			expr_dispose(self->newe.expr);
+			expr_dispose(self->newe.opts.align);
+			expr_dispose(self->newe.opts.arena);
+			free(self->newe.expr);
+			free(self->newe.opts.align);
+			free(self->newe.opts.arena);
 			break;
 		case AST_MAKE_BUILTIN:
 			type_dispose(&self->make.type);
 			expr_dispose(self->make.expr);
+			expr_dispose(self->make.opts.align);
+			expr_dispose(self->make.opts.arena);
 			free(self->make.expr);
+			free(self->make.opts.align);
+			free(self->make.opts.arena);
 			break;
 		case AST_LENCAP_BUILTIN:
 			expr_dispose(self->lencap.expr);
@@ -107,6 +137,38 @@ expr_dispose (expr_t *self) {
 			expr_dispose(self->dispose.expr);
 			free(self->dispose.expr);
 			break;
+		case AST_APPEND_BUILTIN:
+			expr_dispose(self->append.slice);
+			free(self->append.slice);
+			for (i = 0; i < self->append.num_elems; ++i)
+				expr_dispose(self->append.elems + i);
+			free(self->append.elems);
+			break;
+		case AST_COPY_BUILTIN:
+			expr_dispose(self->copy.dst);
+			expr_dispose(self->copy.src);
+			free(self->copy.dst);
+			free(self->copy.src);
+			break;
+		case AST_SHUFFLE_BUILTIN:
+			for (i = 0; i < self->shuffle.num_args; ++i)
+				expr_dispose(self->shuffle.args + i);
+			free(self->shuffle.args);
+			break;
+		case AST_REDUCE_BUILTIN:
+			expr_dispose(self->reduce.expr);
+			free(self->reduce.expr);
+			break;
+		case AST_ATOMIC_BUILTIN:
+			for (i = 0; i < self->atomic.num_args; ++i)
+				expr_dispose(self->atomic.args + i);
+			free(self->atomic.args);
+			break;
+		case AST_INTRINSIC_BUILTIN:
+			for (i = 0; i < self->intrinsic.num_args; ++i)
+				expr_dispose(self->intrinsic.args + i);
+			free(self->intrinsic.args);
+			break;
 		case AST_CAST_EXPR:
 			expr_dispose(self->cast.target);
 			type_dispose(&self->cast.type);
@@ -183,10 +245,18 @@ stmt_dispose (stmt_t *self) {
 		case AST_GOTO_STMT:
 			free(self->name);
 			break;
+		case AST_INDIRECT_GOTO_STMT:
+			expr_dispose(self->expr);
+			free(self->expr);
+			break;
 		case AST_CONTINUE_STMT:
 			break;
 		case AST_BREAK_STMT:
 			break;
+		case AST_UNCHECKED_STMT:
+			stmt_dispose(self->body);
+			free(self->body);
+			break;
 		case AST_RETURN_STMT:
 			expr_dispose(self->expr);
 			free(self->expr);
@@ -284,7 +354,8 @@ type_describe(type_t *self) {
 			s = strdup("bool");
 			break;
 		case AST_INTEGER_TYPE:
-			asprintf(&s, "int%d", self->width);
+			asprintf(&s, "%sint%d%s", self->is_unsigned ? "u" : "", self->width,
+				self->byte_order == AST_BIG_ENDIAN ? "be" : self->byte_order == AST_LITTLE_ENDIAN ? "le" : "");
 			break;
 		case AST_FLOAT_TYPE:
 			asprintf(&s, "float%d", self->width);
@@ -333,6 +404,12 @@ type_describe(type_t *self) {
 			free(t);
 			break;
 		}
+		case AST_VECTOR_TYPE: {
+			char *t = type_describe(self->vector.type);
+			asprintf(&s, "vec<%d,%s>", self->vector.length, t);
+			free(t);
+			break;
+		}
 		case AST_INTERFACE_TYPE:
 			if (self->interface.num_members == 0)
 				s = strdup("interface{}");
@@ -389,6 +466,9 @@ type_copy (type_t *dst, const type_t *src) {
 				dst->strct.members[i].type = malloc(sizeof(type_t));
 				type_copy(dst->strct.members[i].type, src->strct.members[i].type);
 				dst->strct.members[i].name = strdup(src->strct.members[i].name);
+				dst->strct.members[i].align = src->strct.members[i].align;
+				dst->strct.members[i].bits = src->strct.members[i].bits;
+				dst->strct.members[i].loc = src->strct.members[i].loc;
 			}
 			break;
 		case AST_ARRAY_TYPE:
@@ -399,6 +479,10 @@ type_copy (type_t *dst, const type_t *src) {
 			dst->slice.type = malloc(sizeof(type_t));
 			type_copy(dst->slice.type, src->slice.type);
 			break;
+		case AST_VECTOR_TYPE:
+			dst->vector.type = malloc(sizeof(type_t));
+			type_copy(dst->vector.type, src->vector.type);
+			break;
 		case AST_INTERFACE_TYPE:
 			dst->interface.members = malloc(src->interface.num_members * sizeof(interface_member_t));
 			for (i = 0; i < src->interface.num_members; ++i) {
@@ -444,6 +528,7 @@ type_equal (const type_t *a, const type_t *b) {
 		case AST_PLACEHOLDER_TYPE:
 			return 1;
 		case AST_INTEGER_TYPE:
+			return a->width == b->width && a->is_unsigned == b->is_unsigned && a->byte_order == b->byte_order;
 		case AST_FLOAT_TYPE:
 			return a->width == b->width;
 		case AST_NAMED_TYPE:
@@ -458,10 +543,13 @@ type_equal (const type_t *a, const type_t *b) {
 			return 1;
 		}
 		case AST_STRUCT_TYPE: {
-			if (a->strct.num_members != b->strct.num_members)
+			if (a->strct.num_members != b->strct.num_members ||
+			    a->strct.packed != b->strct.packed || a->strct.align != b->strct.align)
 				return 0;
 			for (i = 0; i < a->strct.num_members; ++i)
 				if (strcmp(a->strct.members[i].name, b->strct.members[i].name) != 0 ||
+					a->strct.members[i].align != b->strct.members[i].align ||
+					a->strct.members[i].bits != b->strct.members[i].bits ||
 					!type_equal(a->strct.members[i].type, b->strct.members[i].type))
 					return 0;
 			return 1;
@@ -471,6 +559,8 @@ type_equal (const type_t *a, const type_t *b) {
 		}
 		case AST_ARRAY_TYPE:
 			return a->array.length == b->array.length || type_equal(a->array.type, b->array.type);
+		case AST_VECTOR_TYPE:
+			return a->vector.length == b->vector.length && type_equal(a->vector.type, b->vector.type);
 		case AST_INTERFACE_TYPE: {
 			if (a->interface.num_members != b->interface.num_members)
 				return 0;
@@ -543,6 +633,10 @@ type_dispose (type_t *self) {
 			type_dispose(self->slice.type);
 			free(self->slice.type);
 			break;
+		case AST_VECTOR_TYPE:
+			type_dispose(self->vector.type);
+			free(self->vector.type);
+			break;
 		case AST_INTERFACE_TYPE:
 			for (i = 0; i < self->interface.num_members; ++i) {
 				interface_member_t *m = self->interface.members+i;
@@ -6,6 +6,7 @@
 #define false 0
 typedef unsigned char bool;
 
+typedef struct alloc_opts alloc_opts_t;
 typedef struct array_type array_type_t;
 typedef struct assignment_expr assignment_expr_t;
 typedef struct binary_expr binary_expr_t;
@@ -15,6 +16,7 @@ typedef struct cast_expr cast_expr_t;
 typedef struct comma_expr comma_expr_t;
 typedef struct compound_stmt compound_stmt_t;
 typedef struct conditional_expr conditional_expr_t;
+typedef struct const_value const_value_t;
 typedef struct const_decl const_decl_t;
 typedef struct decl decl_t;
 typedef struct expr expr_t;
@@ -31,7 +33,14 @@ typedef struct interface_type interface_type_t;
 typedef struct iteration_stmt iteration_stmt_t;
 typedef struct label_stmt label_stmt_t;
 typedef struct lencap_builtin lencap_builtin_t;
+typedef struct loop_hints loop_hints_t;
 typedef struct dispose_builtin dispose_builtin_t;
+typedef struct append_builtin append_builtin_t;
+typedef struct copy_builtin copy_builtin_t;
+typedef struct shuffle_builtin shuffle_builtin_t;
+typedef struct reduce_builtin reduce_builtin_t;
+typedef struct atomic_builtin atomic_builtin_t;
+typedef struct intrinsic_builtin intrinsic_builtin_t;
 typedef struct make_builtin make_builtin_t;
 typedef struct member_access_expr member_access_expr_t;
 typedef struct new_builtin new_builtin_t;
@@ -46,6 +55,7 @@ typedef struct type type_t;
 typedef struct type_unit type_unit_t;
 typedef struct unary_expr unary_expr_t;
 typedef struct unit unit_t;
+typedef struct vector_type vector_type_t;
 typedef struct package_unit package_unit_t;
 typedef struct variable_decl variable_decl_t;
 typedef struct implementation_decl implementation_decl_t;
@@ -67,9 +77,16 @@ enum type_kind {
 	AST_SLICE_TYPE,
 	AST_INTERFACE_TYPE,
 	AST_PLACEHOLDER_TYPE,
+	AST_VECTOR_TYPE,
 	AST_NUM_TYPES
 };
 
+enum byte_order {
+	AST_NATIVE_ORDER,
+	AST_BIG_ENDIAN,
+	AST_LITTLE_ENDIAN,
+};
+
 
 struct func_type {
 	type_t *return_type;
@@ -82,11 +99,21 @@ struct struct_type {
 	char *name;
 	unsigned num_members;
 	struct_member_t *members;
+	/// Set for `struct packed`, whose members are laid out without padding.
+	unsigned packed;
+	/// Minimum alignment in bytes given with `alignas`, or 0.
+	unsigned align;
 };
 
 struct struct_member {
 	type_t *type;
 	char *name;
+	/// Minimum alignment in bytes given with `alignas`, or 0.
+	unsigned align;
+	/// Width in bits of a bitfield member, or 0.
+	unsigned bits;
+	/// Location of the member, for errors about its type.
+	loc_t loc;
 };
 
 
@@ -99,6 +126,15 @@ struct slice_type {
 	type_t *type;
 };
 
+/// A SIMD vector `vec<N,T>` of \a length lanes of the integer, float, or
+/// boolean type \a type.
+struct vector_type {
+	type_t *type;
+	unsigned length;
+	/// Location of the type, for errors about its element type.
+	loc_t loc;
+};
+
 
 struct interface_type {
 	unsigned num_members;
@@ -136,11 +172,16 @@ struct type {
 	unsigned pointer;
 	union {
 		char *name;
-		unsigned width;
+		struct {
+			unsigned width;
+			unsigned is_unsigned; // integer types only
+			unsigned byte_order; // integer types only, see enum byte_order
+		};
 		func_type_t func;
 		struct_type_t strct;
 		array_type_t array;
 		slice_type_t slice;
+		vector_type_t vector;
 		interface_type_t interface;
 	};
 };
@@ -171,6 +212,13 @@ enum expr_kind {
 	AST_MAKE_BUILTIN,
 	AST_LENCAP_BUILTIN,
 	AST_DISPOSE_BUILTIN,
+	AST_APPEND_BUILTIN,
+	AST_COPY_BUILTIN,
+	AST_LABEL_ADDR_EXPR,
+	AST_SHUFFLE_BUILTIN,
+	AST_REDUCE_BUILTIN,
+	AST_ATOMIC_BUILTIN,
+	AST_INTRINSIC_BUILTIN,
 	AST_NUM_EXPRS
 };
 
@@ -252,9 +300,21 @@ struct sizeof_expr {
 	};
 };
 
+/// Additional options that may be passed to the new() and make() builtins.
+/// If \a noinit is set, the allocated memory is left uninitialized instead of
+/// being zero-filled. If \a align is non-null, the memory is aligned to the
+/// number of bytes it evaluates to. If \a arena is non-null, the memory is
+/// allocated from the arena it points to rather than the heap.
+struct alloc_opts {
+	unsigned noinit;
+	expr_t *align;
+	expr_t *arena;
+};
+
 struct new_builtin {
 	type_t type;
 	expr_t *expr;
+	alloc_opts_t opts;
 };
 
 struct free_builtin {
@@ -264,6 +324,7 @@ struct free_builtin {
 struct make_builtin {
 	type_t type;
 	expr_t *expr;
+	alloc_opts_t opts;
 };
 
 enum lencap_kind {
@@ -280,6 +341,120 @@ struct dispose_builtin {
 	expr_t *expr;
 };
 
+/// The append() builtin. Appends the \a num_elems elements in \a elems to the
+/// slice \a slice, which must be an lvalue. If \a spread is set, \a elems
+/// holds a single slice whose elements are appended, as in `append(s, t...)`.
+struct append_builtin {
+	expr_t *slice;
+	unsigned num_elems;
+	expr_t *elems;
+	unsigned spread;
+};
+
+/// The copy() builtin. Copies as many elements as both slices can hold from
+/// \a src to \a dst, and evaluates to the number of elements copied.
+struct copy_builtin {
+	expr_t *dst;
+	expr_t *src;
+};
+
+/// The shuffle() builtin. Builds a vector from lanes of one or two vectors of
+/// the same type, selected by constant indices, as in `shuffle(a, b, 0, 4)`.
+/// Lanes of the second vector are numbered after those of the first.
+struct shuffle_builtin {
+	unsigned num_args;
+	expr_t *args;
+};
+
+enum reduce_op {
+	AST_REDUCE_ADD,
+	AST_REDUCE_MUL,
+	AST_REDUCE_AND,
+	AST_REDUCE_OR,
+	AST_REDUCE_XOR,
+	AST_REDUCE_MIN,
+	AST_REDUCE_MAX,
+};
+
+/// The reduce() builtin. Combines all lanes of the vector \a expr with the
+/// operation \a op, as in `reduce(add, v)`.
+struct reduce_builtin {
+	unsigned op;
+	expr_t *expr;
+};
+
+enum atomic_op {
+	AST_ATOMIC_LOAD,
+	AST_ATOMIC_STORE,
+	AST_ATOMIC_XCHG,
+	AST_ATOMIC_ADD,
+	AST_ATOMIC_SUB,
+	AST_ATOMIC_AND,
+	AST_ATOMIC_OR,
+	AST_ATOMIC_XOR,
+	AST_ATOMIC_MIN,
+	AST_ATOMIC_MAX,
+	AST_ATOMIC_CMPXCHG,
+	AST_ATOMIC_FENCE,
+};
+
+enum atomic_order {
+	AST_ATOMIC_SEQ_CST,
+	AST_ATOMIC_RELAXED,
+	AST_ATOMIC_ACQUIRE,
+	AST_ATOMIC_RELEASE,
+	AST_ATOMIC_ACQ_REL,
+};
+
+/// The atomic() builtin. Performs the operation  op on the memory the first
+/// argument points to, e.g. `atomic(add, &counter, 1, relaxed)`. The memory
+/// ordering is given as an optional last argument and defaults to seq_cst.
+/// Read-modify-write operations and cmpxchg evaluate to the previous value.
+struct atomic_builtin {
+	unsigned op;
+	unsigned order;
+	unsigned num_args;
+	expr_t *args;
+};
+
+enum intrinsic_op {
+	AST_INTRINSIC_CTPOP,
+	AST_INTRINSIC_CTTZ,
+	AST_INTRINSIC_CTLZ,
+	AST_INTRINSIC_BSWAP,
+	AST_INTRINSIC_FSHL,
+	AST_INTRINSIC_FSHR,
+	AST_INTRINSIC_ROTL,
+	AST_INTRINSIC_ROTR,
+	AST_INTRINSIC_PREFETCH,
+	AST_INTRINSIC_EXPECT,
+	AST_INTRINSIC_LIKELY,
+	AST_INTRINSIC_UNLIKELY,
+	AST_INTRINSIC_ASSUME,
+	AST_INTRINSIC_ADD_OVERFLOW,
+	AST_INTRINSIC_SUB_OVERFLOW,
+	AST_INTRINSIC_MUL_OVERFLOW,
+	AST_NUM_INTRINSICS
+};
+
+struct intrinsic_info {
+	const char *name;
+	unsigned min_args;
+	unsigned max_args;
+};
+
+/// Name and number of arguments of each intrinsic operation.
+extern const struct intrinsic_info intrinsic_ops[AST_NUM_INTRINSICS];
+
+/// The intrinsic() builtin. Exposes bit manipulation, hints to the optimizer,
+/// and overflow-checked arithmetic, e.g. `intrinsic(ctpop, mask)` or
+/// `intrinsic(add_overflow, a, b, &sum)`.
+struct intrinsic_builtin {
+	unsigned op;
+	unsigned num_args;
+	expr_t *args;
+};
+
 struct cast_expr {
 	expr_t *target;
 	type_t type;
@@ -354,10 +529,21 @@ struct number_literal {
 	int radix;
 };
 
+/// Value of an expression that is known at compile time. Integers, booleans,
+/// and pointers are stored in `i`, floating point numbers in `f`.
+struct const_value {
+	unsigned known;
+	union {
+		long long i;
+		double f;
+	};
+};
+
 struct expr {
 	unsigned kind;
 	loc_t loc;
 	type_t type;
+	const_value_t constant;
 	union {
 		char *ident;
 		char *string_literal;
@@ -379,6 +565,12 @@ struct expr {
 		comma_expr_t comma;
 		lencap_builtin_t lencap;
 		dispose_builtin_t dispose;
+		append_builtin_t append;
+		copy_builtin_t copy;
+		shuffle_builtin_t shuffle;
+		reduce_builtin_t reduce;
+		atomic_builtin_t atomic;
+		intrinsic_builtin_t intrinsic;
 	};
 };
 
@@ -394,12 +586,14 @@ enum stmt_kind {
 	AST_DO_STMT,
 	AST_FOR_STMT,
 	AST_GOTO_STMT,
+	AST_INDIRECT_GOTO_STMT,
 	AST_CONTINUE_STMT,
 	AST_BREAK_STMT,
 	AST_RETURN_STMT,
 	AST_LABEL_STMT,
 	AST_CASE_STMT,
 	AST_DEFAULT_STMT,
+	AST_UNCHECKED_STMT,
 };
 
 
@@ -416,11 +610,22 @@ struct selection_stmt {
 };
 
 
+/// Optimization hints attached to a loop by prefixing it with `unroll`,
+/// `unroll(N)`, `vectorize`, or `vectorize(N)`. A count of 0 leaves the choice
+/// to the optimizer.
+struct loop_hints {
+	unsigned unroll;
+	unsigned unroll_count;
+	unsigned vectorize;
+	unsigned vectorize_width;
+};
+
 struct iteration_stmt {
 	expr_t *initial;
 	expr_t *condition;
 	expr_t *step;
 	stmt_t *stmt;
+	loop_hints_t hints;
 };
 
 
@@ -443,6 +648,7 @@ struct stmt {
 		selection_stmt_t selection;
 		iteration_stmt_t iteration;
 		label_stmt_t label;
+		stmt_t *body;
 	};
 };
 
@@ -477,10 +683,24 @@ enum decl_kind {
 };
 
 
+/// Thread-local storage models of global variables, from the most general
+/// to the most restrictive. AST_TLS_NONE denotes an ordinary global.
+enum tls_model {
+	AST_TLS_NONE,
+	AST_TLS_GENERAL_DYNAMIC,
+	AST_TLS_LOCAL_DYNAMIC,
+	AST_TLS_INITIAL_EXEC,
+	AST_TLS_LOCAL_EXEC,
+};
+
+
 struct variable_decl {
 	type_t type;
 	char *name;
 	expr_t *initial;
+	unsigned tls_model;
+	/// Minimum alignment in bytes given with `alignas`, or 0.
+	unsigned align;
 };
 
 
@@ -534,9 +754,27 @@ struct func_unit {
 	unsigned num_params;
 	func_param_t *params;
 	unsigned variadic;
+	/// Set for `const func` declarations, which may be evaluated at compile
+	/// time when called from a const declaration.
+	unsigned is_const;
+	/// Attributes given in front of the declaration, see enum func_attr.
+	unsigned attrs;
 	type_t type;
 };
 
+/// Attributes that may precede a function declaration, e.g.
+/// `cold noinline func fail() void`. Inline functions are generated in every
+/// module that imports them, such that calls may be inlined across modules.
+enum func_attr {
+	AST_FUNC_CONST         = 1 << 0, // only while parsing, see is_const
+	AST_FUNC_INLINE        = 1 << 1,
+	AST_FUNC_ALWAYS_INLINE = 1 << 2,
+	AST_FUNC_NOINLINE      = 1 << 3,
+	AST_FUNC_HOT           = 1 << 4,
+	AST_FUNC_COLD          = 1 << 5,
+	AST_FUNC_PURE          = 1 << 6,
+};
+
 struct package_unit {
 	char *name;
 };
@@ -544,6 +782,9 @@ struct package_unit {
 struct func_param {
 	type_t type;
 	char *name;
+	/// Set for `restrict` parameters, whose memory is not accessed through
+	/// any other pointer while the function runs.
+	unsigned noalias;
 };
 
 
@@ -3,7 +3,11 @@
 #include "codegen.h"
 #include "codegen_funcs.h"
 #include "common.h"
+#include "llvm_intrinsics.h"
 #include <llvm-c/Analysis.h>
+#include <llvm-c/DebugInfo.h>
+#include <llvm-c/TargetMachine.h>
+#include <llvm-c/Transforms/Utils.h>
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -104,6 +108,48 @@ resolve_type_name (codegen_context_t *context, type_t *type) {
 	}
 }
 
+
+static char *target_triple;
+static LLVMTargetDataRef target_data;
+
+/*
+ * Returns the data layout of the target code is generated for, which is the
+ * host. Struct layouts with explicit alignment are computed against it. Falls
+ * back to LLVM's default layout if the host target is not available.
+ */
+LLVMTargetDataRef
+codegen_target_data(void) {
+	if (target_data)
+		return target_data;
+	target_triple = LLVMGetDefaultTargetTriple();
+	LLVMTargetRef target;
+	char *error = 0;
+	if (LLVMInitializeNativeTarget() == 0 && LLVMGetTargetFromTriple(target_triple, &target, &error) == 0) {
+		LLVMTargetMachineRef machine = LLVMCreateTargetMachine(target, target_triple, "", "",
+			LLVMCodeGenLevelDefault, LLVMRelocDefault, LLVMCodeModelDefault);
+		target_data = LLVMCreateTargetDataLayout(machine);
+		LLVMDisposeTargetMachine(machine);
+	} else {
+		LLVMDisposeMessage(target_triple);
+		target_triple = 0;
+		target_data = LLVMCreateTargetData("");
+	}
+	LLVMDisposeMessage(error);
+	return target_data;
+}
+
+/*
+ * Sets the triple and data layout of a module to the ones of the target code
+ * is generated for.
+ */
+void
+codegen_set_target(LLVMModuleRef module) {
+	LLVMSetModuleDataLayout(module, codegen_target_data());
+	if (target_triple)
+		LLVMSetTarget(module, target_triple);
+}
+
+
 void
 prepare_expr (codegen_t *self, codegen_context_t *context, expr_t *expr, type_t *type_hint) {
 	assert(self);
@@ -111,7 +157,11 @@ prepare_expr (codegen_t *self, codegen_context_t *context, expr_t *expr, type_t
 	assert(expr);
 
 	prepare_expr_fn_t fn = prepare_expr_fn[expr->kind];
-	if (fn) return fn(self, context, expr, type_hint);
+	if (fn) {
+		fn(self, context, expr, type_hint);
+		codegen_const_eval(context, expr);
+		return;
+	}
 
 	unsigned i;
 	switch (expr->kind) {
@@ -137,6 +187,10 @@ codegen_expr (codegen_t *self, codegen_context_t *context, expr_t *expr, char lv
 	assert(expr);
 	/// TODO(fabianschuiki): Split this function up into three functions. One for rvalues that returns the corresponding value, one for lvalues that returns a pointer to the corresponding value, and one for rvalue pointers that returns a pointer to the corresponding value. These will be used for regular expressions, assignments, and struct member accesses respectively.
 
+	// Values known at compile time need no instructions.
+	if (expr->constant.known && !lvalue)
+		return codegen_const_value(context, expr);
+
 	codegen_expr_fn_t fn = codegen_expr_fn[expr->kind];
 	if (fn) return fn(self, context, expr, lvalue);
 
@@ -169,6 +223,251 @@ codegen_expr_top (codegen_t *self, codegen_context_t *context, expr_t *expr, cha
 }
 
 
+/*
+ * Creates a stack slot in the entry block of the current function. Keeping
+ * all allocas there avoids growing the stack in loops and allows them to be
+ * promoted to SSA values.
+ */
+LLVMValueRef
+codegen_alloca(codegen_t *self, LLVMTypeRef type, const char *name) {
+	assert(self->alloca_builder && "stack slot outside of a function");
+	return LLVMBuildAlloca(self->alloca_builder, type, name);
+}
+
+
+/*
+ * Returns the label with the given name in the current function, creating
+ * its block if the label has not been referred to before. The location is
+ * used to report labels that are never defined.
+ */
+codegen_label_t *
+codegen_label(codegen_t *self, const char *name, loc_t *loc) {
+	assert(self->labels && "label outside of a function");
+	unsigned i;
+	for (i = 0; i < self->labels->size; ++i) {
+		codegen_label_t *label = array_get(self->labels, i);
+		if (strcmp(label->name, name) == 0)
+			return label;
+	}
+	codegen_label_t label = {
+		.name = strdup(name),
+		.block = LLVMAppendBasicBlock(self->func, name),
+		.loc = *loc,
+	};
+	return array_add(self->labels, &label);
+}
+
+
+/*
+ * Checks whether a for loop has the form `for i = a; i < b; ++i`, where the
+ * comparison may be any relational operator or `!=`, and the step any
+ * increment or decrement of i.
+ */
+static int
+is_canonical_loop(stmt_t *stmt) {
+	expr_t *init = stmt->iteration.initial;
+	expr_t *cond = stmt->iteration.condition;
+	expr_t *step = stmt->iteration.step;
+	if (!init || !cond || !step)
+		return 0;
+
+	if (init->kind != AST_ASSIGNMENT_EXPR || init->assignment.op != AST_ASSIGN ||
+	    init->assignment.target->kind != AST_IDENT_EXPR)
+		return 0;
+	const char *name = init->assignment.target->ident;
+
+	if (cond->kind != AST_BINARY_EXPR || cond->binary_op.op < AST_LT || cond->binary_op.op > AST_NE ||
+	    cond->binary_op.op == AST_EQ)
+		return 0;
+	expr_t *lhs = cond->binary_op.lhs;
+	if (lhs->kind != AST_IDENT_EXPR || strcmp(lhs->ident, name) != 0)
+		return 0;
+
+	expr_t *target;
+	if (step->kind == AST_INCDEC_EXPR)
+		target = step->incdec_op.target;
+	else if (step->kind == AST_ASSIGNMENT_EXPR &&
+	         (step->assignment.op == AST_ADD_ASSIGN || step->assignment.op == AST_SUB_ASSIGN))
+		target = step->assignment.target;
+	else
+		return 0;
+	return target->kind == AST_IDENT_EXPR && strcmp(target->ident, name) == 0;
+}
+
+/*
+ * Attaches the `llvm.loop` metadata for the given hints to the branch from the
+ * latch of a loop back to its header.
+ */
+static void
+set_loop_hints(LLVMValueRef br, const loop_hints_t *hints) {
+	if (!hints->unroll && !hints->vectorize)
+		return;
+	LLVMContextRef ctx = LLVMGetGlobalContext();
+	LLVMMetadataRef ops[5];
+	unsigned num_ops = 1;
+
+	#define HINT(name, value) { \
+		LLVMMetadataRef hint[2] = { LLVMMDStringInContext2(ctx, name, strlen(name)), value }; \
+		ops[num_ops++] = LLVMMDNodeInContext2(ctx, hint, value ? 2 : 1); \
+	}
+	#define COUNT(n) LLVMValueAsMetadata(LLVMConstInt(LLVMInt32Type(), n, 0))
+	if (hints->unroll && hints->unroll_count)
+		HINT("llvm.loop.unroll.count", COUNT(hints->unroll_count))
+	else if (hints->unroll)
+		HINT("llvm.loop.unroll.enable", 0)
+	if (hints->vectorize) {
+		HINT("llvm.loop.vectorize.enable", LLVMValueAsMetadata(LLVMConstInt(LLVMInt1Type(), 1, 0)))
+		if (hints->vectorize_width)
+			HINT("llvm.loop.vectorize.width", COUNT(hints->vectorize_width))
+	}
+	#undef COUNT
+	#undef HINT
+
+	// The loop ID refers to itself, which requires a temporary placeholder.
+	LLVMMetadataRef tmp = LLVMTemporaryMDNode(ctx, 0, 0);
+	ops[0] = tmp;
+	LLVMMetadataRef loop = LLVMMDNodeInContext2(ctx, ops, num_ops);
+	LLVMMetadataReplaceAllUsesWith(tmp, loop);
+	LLVMSetMetadata(br, LLVMGetMDKindID("llvm.loop", 9), LLVMMetadataAsValue(ctx, loop));
+}
+
+
+/// Returns whether an expression contains a function call.
+static int
+has_call(expr_t *expr) {
+	if (!expr)
+		return 0;
+	unsigned i;
+	switch (expr->kind) {
+		case AST_CALL_EXPR:
+			return 1;
+		case AST_INDEX_ACCESS_EXPR:
+			return has_call(expr->index_access.target) || has_call(expr->index_access.index);
+		case AST_MEMBER_ACCESS_EXPR:
+			return has_call(expr->member_access.target);
+		case AST_UNARY_EXPR:
+			return has_call(expr->unary_op.target);
+		case AST_CAST_EXPR:
+			return has_call(expr->cast.target);
+		case AST_BINARY_EXPR:
+			return has_call(expr->binary_op.lhs) || has_call(expr->binary_op.rhs);
+		case AST_CONDITIONAL_EXPR:
+			return has_call(expr->conditional.condition) ||
+				has_call(expr->conditional.true_expr) ||
+				has_call(expr->conditional.false_expr);
+		case AST_COMMA_EXPR:
+			for (i = 0; i < expr->comma.num_exprs; ++i)
+				if (has_call(expr->comma.exprs + i))
+					return 1;
+			return 0;
+		default:
+			return 0;
+	}
+}
+
+/*
+ * Evaluates the initializer of a global at compile time. Calls to const
+ * functions are evaluated by the interpreter. Returns null if the expression
+ * does not fold to a constant.
+ */
+static LLVMValueRef
+codegen_global_value (codegen_t *self, codegen_context_t *context, expr_t *expr, type_t *type) {
+	// Outside of functions, a detached builder suffices since it folds
+	// operations on constants without emitting instructions.
+	codegen_t cg = *self;
+	cg.const_eval = 1;
+	if (!cg.builder)
+		cg.builder = LLVMCreateBuilder();
+	LLVMValueRef value = codegen_expr_top(&cg, context, expr, 0, type);
+	if (cg.builder != self->builder)
+		LLVMDisposeBuilder(cg.builder);
+	return LLVMIsConstant(value) ? value : 0;
+}
+
+/*
+ * Generates the value of a typed const declaration and sets it as the
+ * initializer of its global.
+ */
+static void
+codegen_const_init (codegen_t *self, codegen_context_t *context, decl_t *decl, LLVMValueRef global) {
+	LLVMValueRef value = codegen_global_value(self, context, &decl->cons.value, decl->cons.type);
+	if (!value)
+		derror(&decl->cons.value.loc, "value of const '%s' is not a constant expression\n", decl->cons.name);
+	LLVMSetInitializer(global, codegen_memory_const(context, value, decl->cons.type));
+}
+
+/*
+ * Aligns the storage of a variable as requested by its declaration or
+ * required by its type, unless it is aligned sufficiently already.
+ */
+static void
+codegen_variable_align (codegen_context_t *context, decl_t *decl, LLVMValueRef var) {
+	unsigned align = codegen_type_align(context, &decl->variable.type);
+	if (decl->variable.align > align)
+		align = decl->variable.align;
+	LLVMTypeRef type = codegen_type(context, &decl->variable.type);
+	if (align > LLVMGetAlignment(var) && align > LLVMABIAlignmentOfType(codegen_target_data(), type))
+		LLVMSetAlignment(var, align);
+}
+
+/*
+ * Declares a variable outside of any function as a global. The global is only
+ * defined with its initial value by codegen_global_init, such that modules
+ * importing the declaration refer to the definition in the declaring module.
+ */
+static void
+codegen_global_decl (codegen_t *self, codegen_context_t *context, decl_t *decl) {
+	variable_decl_t *var = &decl->variable;
+	if (var->type.kind == AST_NO_TYPE) {
+		prepare_expr(self, context, var->initial, 0);
+		if (var->initial->type.kind == AST_NO_TYPE)
+			derror(&decl->loc, "type of variable '%s' could not be inferred from its initial value\n", var->name);
+		type_copy(&var->type, &var->initial->type);
+	}
+
+	LLVMValueRef global = LLVMAddGlobal(self->module, codegen_type(context, &var->type), var->name);
+	codegen_variable_align(context, decl, global);
+	if (var->tls_model != AST_TLS_NONE) {
+		static const LLVMThreadLocalMode modes[] = {
+			[AST_TLS_GENERAL_DYNAMIC] = LLVMGeneralDynamicTLSModel,
+			[AST_TLS_LOCAL_DYNAMIC]   = LLVMLocalDynamicTLSModel,
+			[AST_TLS_INITIAL_EXEC]    = LLVMInitialExecTLSModel,
+			[AST_TLS_LOCAL_EXEC]      = LLVMLocalExecTLSModel,
+		};
+		LLVMSetThreadLocalMode(global, modes[var->tls_model]);
+	}
+
+	codegen_symbol_t sym = {
+		.name = var->name,
+		.type = &var->type,
+		.decl = decl,
+		.value = global,
+	};
+	codegen_context_add_symbol(context, &sym);
+}
+
+static void
+codegen_global_init (codegen_t *self, codegen_context_t *context, decl_t *decl) {
+	variable_decl_t *var = &decl->variable;
+	codegen_symbol_t *sym = codegen_context_find_symbol(context, var->name);
+	assert(sym && sym->decl == decl && "global not declared");
+
+	LLVMValueRef value = LLVMConstNull(codegen_type(context, &var->type));
+	if (var->initial) {
+		value = codegen_global_value(self, context, var->initial, &var->type);
+		if (!value)
+			derror(&var->initial->loc, "initial value of global '%s' is not a constant expression\n", var->name);
+		if (!type_equal(&var->type, &var->initial->type)) {
+			char *t1 = type_describe(&var->initial->type);
+			char *t2 = type_describe(&var->type);
+			derror(&var->initial->loc, "initial value of variable '%s' is of type %s, but should be %s\n", var->name, t1, t2);
+			free(t1);
+			free(t2);
+		}
+	}
+	LLVMSetInitializer(sym->value, codegen_memory_const(context, value, &var->type));
+}
+
 static void
 codegen_decl (codegen_t *self, codegen_context_t *context, decl_t *decl) {
 	assert(self);
@@ -177,9 +476,12 @@ codegen_decl (codegen_t *self, codegen_context_t *context, decl_t *decl) {
 
 	switch(decl->kind) {
 		case AST_VARIABLE_DECL: {
-			if (decl->variable.type.kind != AST_NO_TYPE) {
+			if (!self->func) {
+				codegen_global_decl(self, context, decl);
+			} else if (decl->variable.type.kind != AST_NO_TYPE) {
 				LLVMTypeRef var_type = codegen_type(context, &decl->variable.type);
-				LLVMValueRef var = LLVMBuildAlloca(self->builder, var_type, decl->variable.name);
+				LLVMValueRef var = codegen_alloca(self, var_type, decl->variable.name);
+				codegen_variable_align(context, decl, var);
 
 				codegen_symbol_t sym = {
 					.name = decl->variable.name,
@@ -198,7 +500,7 @@ codegen_decl (codegen_t *self, codegen_context_t *context, decl_t *decl) {
 						free(t1);
 						free(t2);
 					}
-					LLVMBuildStore(self->builder, val, var);
+					codegen_store(self, context, val, var, &decl->variable.type, 0);
 				} else {
 					LLVMBuildStore(self->builder, LLVMConstNull(var_type), var);
 				}
@@ -208,8 +510,9 @@ codegen_decl (codegen_t *self, codegen_context_t *context, decl_t *decl) {
 					derror(&decl->loc, "type of variable '%s' could not be inferred from its initial value\n", decl->variable.name);
 				type_copy(&decl->variable.type, &decl->variable.initial->type);
 
-				LLVMValueRef var = LLVMBuildAlloca(self->builder, codegen_type(context, &decl->variable.type), decl->variable.name);
-				LLVMBuildStore(self->builder, val, var);
+				LLVMValueRef var = codegen_alloca(self, codegen_type(context, &decl->variable.type), decl->variable.name);
+				codegen_variable_align(context, decl, var);
+				codegen_store(self, context, val, var, &decl->variable.type, 0);
 
 				codegen_symbol_t sym = {
 					.name = decl->variable.name,
@@ -230,11 +533,16 @@ codegen_decl (codegen_t *self, codegen_context_t *context, decl_t *decl) {
 			};
 
 			if (decl->cons.type) {
-				LLVMValueRef value = codegen_expr_top(self, context, &decl->cons.value, 0, decl->cons.type);
 				LLVMValueRef global = LLVMAddGlobal(self->module, codegen_type(context, decl->cons.type), decl->cons.name);
-				LLVMSetInitializer(global, value);
 				LLVMSetLinkage(global, LLVMLinkOnceODRLinkage);
+				LLVMSetGlobalConstant(global, 1);
 				sym.value = global;
+
+				// Outside of functions, values involving calls are computed
+				// once the bodies of const functions have been generated.
+				// See codegen_decls.
+				if (self->func || !has_call(&decl->cons.value))
+					codegen_const_init(self, context, decl, global);
 			}
 
 			codegen_context_add_symbol(context, &sym);
@@ -304,8 +612,7 @@ codegen_stmt (codegen_t *self, codegen_context_t *context, stmt_t *stmt) {
 			context_t subctx;
 			codegen_context_init(&subctx);
 			subctx.prev = context;
-			LLVMValueRef cond = codegen_expr_top(self, &subctx, stmt->selection.condition, 0, &bool_type);
-
+			prepare_expr(self, &subctx, stmt->selection.condition, &bool_type);
 			if (!type_equal(&stmt->selection.condition->type, &bool_type)) {
 				char *td = type_describe(&stmt->selection.condition->type);
 				derror(&stmt->loc, "if condition must be a bool expression, got %s instead\n", td);
@@ -316,7 +623,7 @@ codegen_stmt (codegen_t *self, codegen_context_t *context, stmt_t *stmt) {
 			LLVMBasicBlockRef true_block = LLVMAppendBasicBlock(func, "iftrue");
 			LLVMBasicBlockRef false_block = stmt->selection.else_stmt ? LLVMAppendBasicBlock(func, "iffalse") : 0;
 			LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(func, "ifexit");
-			LLVMBuildCondBr(self->builder, cond, true_block, false_block ? false_block : exit_block);
+			codegen_cond_br(self, &subctx, stmt->selection.condition, true_block, false_block ? false_block : exit_block);
 
 			context_t true_context;
 			codegen_context_init(&true_context);
@@ -358,45 +665,235 @@ codegen_stmt (codegen_t *self, codegen_context_t *context, stmt_t *stmt) {
 			if (stmt->iteration.initial)
 				codegen_expr_top(self, &subctx, stmt->iteration.initial, 0, 0);
 
+			// Loops over an induction variable are emitted in rotated form,
+			// i.e. with the condition checked once before entering the loop
+			// and then again at the bottom of the body. This leaves a single
+			// block that branches back to the loop header, as expected by the
+			// loop optimizations.
+			int rotated = is_canonical_loop(stmt);
+			if (stmt->iteration.condition)
+				prepare_expr(self, &subctx, stmt->iteration.condition, &bool_type);
+
+			// Slice accesses guarded by the loop condition need no bounds
+			// check, or one in a guard block ahead of the loop.
 			LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(self->builder));
-			LLVMBasicBlockRef loop_block = LLVMAppendBasicBlock(func, "loopcond");
+			bounds_fact_t fact;
+			LLVMBasicBlockRef entry_block = 0;
+			int has_fact = codegen_bounds_loop_fact(self, &subctx, stmt, &fact);
+			if (has_fact) {
+				fact.guard = LLVMAppendBasicBlock(func, "loopguard");
+				entry_block = LLVMAppendBasicBlock(func, "loopentry");
+				LLVMBuildBr(self->builder, fact.guard);
+				LLVMPositionBuilderAtEnd(self->builder, entry_block);
+			}
+
+			LLVMBasicBlockRef loop_block = rotated ? 0 : LLVMAppendBasicBlock(func, "loopcond");
 			LLVMBasicBlockRef body_block = LLVMAppendBasicBlock(func, "loopbody");
 			LLVMBasicBlockRef step_block = LLVMAppendBasicBlock(func, "loopstep");
 			LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(func, "loopexit");
-			LLVMBuildBr(self->builder, loop_block);
+			if (!rotated) {
+				LLVMBuildBr(self->builder, loop_block);
+				LLVMPositionBuilderAtEnd(self->builder, loop_block);
+			}
 
 			codegen_t cg = *self;
 			cg.continue_block = step_block;
 			cg.break_block = exit_block;
 
 			// Check the loop condition.
-			LLVMPositionBuilderAtEnd(self->builder, loop_block);
 			if (stmt->iteration.condition) {
-				LLVMValueRef cond = codegen_expr_top(self, &subctx, stmt->iteration.condition, 0, &bool_type);
-				LLVMBuildCondBr(self->builder, cond, body_block, exit_block);
+				codegen_cond_br(self, &subctx, stmt->iteration.condition, body_block, exit_block);
 			} else {
 				LLVMBuildBr(self->builder, body_block);
 			}
 
+			if (has_fact) {
+				fact.straight = body_block;
+				fact.prev = cg.bounds_facts;
+				cg.bounds_facts = &fact;
+			}
+
 			// Execute the loop body.
+			context_t body_context;
+			codegen_context_init(&body_context);
+			body_context.prev = &subctx;
 			LLVMPositionBuilderAtEnd(self->builder, body_block);
 			if (stmt->iteration.stmt) {
-				codegen_stmt(&cg, &subctx, stmt->iteration.stmt);
+				codegen_stmt(&cg, &body_context, stmt->iteration.stmt);
 			}
-			LLVMBuildBr(self->builder, step_block);
+			if (!body_context.is_terminated)
+				LLVMBuildBr(self->builder, step_block);
+			codegen_context_dispose(&body_context);
 
-			// Execute the loop step.
+			// Execute the loop step and branch back to the top.
 			LLVMPositionBuilderAtEnd(self->builder, step_block);
 			if (stmt->iteration.step) {
 				codegen_expr_top(self, &subctx, stmt->iteration.step, 0, 0);
 			}
-			LLVMBuildBr(self->builder, loop_block);
+			// Loop hints are attached to the single branch back to the top,
+			// so the condition is only lowered to a tree of branches if there
+			// are no hints.
+			const loop_hints_t *hints = &stmt->iteration.hints;
+			if (!rotated) {
+				set_loop_hints(LLVMBuildBr(self->builder, loop_block), hints);
+			} else if (hints->unroll || hints->vectorize) {
+				LLVMValueRef cond = codegen_expr(self, &subctx, stmt->iteration.condition, 0, &bool_type);
+				set_loop_hints(LLVMBuildCondBr(self->builder, cond, body_block, exit_block), hints);
+			} else {
+				codegen_cond_br(self, &subctx, stmt->iteration.condition, body_block, exit_block);
+			}
+
+			if (has_fact) {
+				LLVMPositionBuilderAtEnd(self->builder, fact.guard);
+				LLVMBuildBr(self->builder, entry_block);
+				array_dispose(&fact.checked);
+			}
 
 			LLVMPositionBuilderAtEnd(self->builder, exit_block);
 			codegen_context_dispose(&subctx);
 			break;
 		}
 
+		case AST_SWITCH_STMT: {
+			LLVMValueRef cond = codegen_expr_top(self, context, stmt->selection.condition, 0, 0);
+			type_t *type = resolve_type_name(context, &stmt->selection.condition->type);
+			if (type->kind != AST_INTEGER_TYPE || type->pointer > 0) {
+				char *td = type_describe(&stmt->selection.condition->type);
+				derror(&stmt->loc, "switch condition must be an integer expression, got %s instead\n", td);
+				free(td);
+			}
+
+			// The case and default labels in the body add themselves to the
+			// switch instruction. If there is no default label, the default
+			// block simply leaves the switch.
+			LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(self->builder));
+			codegen_switch_t sw;
+			bzero(&sw, sizeof sw);
+			sw.type = &stmt->selection.condition->type;
+			sw.default_block = LLVMAppendBasicBlock(func, "switchdefault");
+			sw.inst = LLVMBuildSwitch(self->builder, cond, sw.default_block, 4);
+			array_init(&sw.values, sizeof(LLVMValueRef));
+			LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(func, "switchexit");
+
+			codegen_t cg = *self;
+			cg.break_block = exit_block;
+			cg.switch_stmt = &sw;
+
+			// Statements before the first label are unreachable. They are
+			// generated into a separate block that is removed afterwards.
+			LLVMBasicBlockRef dead_block = LLVMAppendBasicBlock(func, "switchbody");
+			LLVMPositionBuilderAtEnd(self->builder, dead_block);
+
+			context_t subctx;
+			codegen_context_init(&subctx);
+			subctx.prev = context;
+			if (stmt->selection.stmt)
+				codegen_stmt(&cg, &subctx, stmt->selection.stmt);
+			if (!subctx.is_terminated)
+				LLVMBuildBr(self->builder, exit_block);
+			codegen_context_dispose(&subctx);
+
+			if (!sw.has_default) {
+				LLVMPositionBuilderAtEnd(self->builder, sw.default_block);
+				LLVMBuildBr(self->builder, exit_block);
+			}
+			LLVMDeleteBasicBlock(dead_block);
+			array_dispose(&sw.values);
+
+			LLVMPositionBuilderAtEnd(self->builder, exit_block);
+			break;
+		}
+
+		case AST_CASE_STMT:
+		case AST_DEFAULT_STMT: {
+			codegen_switch_t *sw = self->switch_stmt;
+			if (!sw)
+				derror(&stmt->loc, "%s label outside of a switch statement\n", stmt->kind == AST_CASE_STMT ? "case" : "default");
+
+			LLVMBasicBlockRef block;
+			if (stmt->kind == AST_CASE_STMT) {
+				LLVMValueRef value = codegen_expr_top(self, context, stmt->label.expr, 0, sw->type);
+				if (!type_equal(&stmt->label.expr->type, sw->type)) {
+					char *t1 = type_describe(&stmt->label.expr->type);
+					char *t2 = type_describe(sw->type);
+					derror(&stmt->label.expr->loc, "case value is of type %s, but the switch condition is of type %s\n", t1, t2);
+					free(t1);
+					free(t2);
+				}
+				if (!LLVMIsAConstantInt(value))
+					derror(&stmt->label.expr->loc, "case value must be an integer constant\n");
+				for (i = 0; i < sw->values.size; ++i)
+					if (*(LLVMValueRef*)array_get(&sw->values, i) == value)
+						derror(&stmt->loc, "duplicate case value %lld\n", LLVMConstIntGetSExtValue(value));
+				array_add(&sw->values, &value);
+
+				LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(self->builder));
+				block = LLVMAppendBasicBlock(func, "case");
+				LLVMAddCase(sw->inst, value, block);
+			} else {
+				if (sw->has_default)
+					derror(&stmt->loc, "multiple default labels in one switch statement\n");
+				sw->has_default = 1;
+				block = sw->default_block;
+				LLVMMoveBasicBlockAfter(block, LLVMGetInsertBlock(self->builder));
+			}
+
+			// Fall through from the preceding statements.
+			if (!context->is_terminated)
+				LLVMBuildBr(self->builder, block);
+			context->is_terminated = 0;
+			LLVMPositionBuilderAtEnd(self->builder, block);
+			if (stmt->label.stmt)
+				codegen_stmt(self, context, stmt->label.stmt);
+			break;
+		}
+
+		case AST_LABEL_STMT: {
+			codegen_label_t *label = codegen_label(self, stmt->label.name, &stmt->loc);
+			if (label->defined)
+				derror(&stmt->loc, "label '%s' defined more than once\n", stmt->label.name);
+			label->defined = 1;
+			LLVMMoveBasicBlockAfter(label->block, LLVMGetInsertBlock(self->builder));
+
+			// Fall through from the preceding statements.
+			if (!context->is_terminated)
+				LLVMBuildBr(self->builder, label->block);
+			context->is_terminated = 0;
+			LLVMPositionBuilderAtEnd(self->builder, label->block);
+			if (stmt->label.stmt)
+				codegen_stmt(self, context, stmt->label.stmt);
+			break;
+		}
+
+		case AST_GOTO_STMT: {
+			codegen_label_t *label = codegen_label(self, stmt->name, &stmt->loc);
+			LLVMBuildBr(self->builder, label->block);
+			context->is_terminated = 1;
+			break;
+		}
+
+		case AST_INDIRECT_GOTO_STMT: {
+			LLVMValueRef addr = codegen_expr_top(self, context, stmt->expr, 0, 0);
+			type_t *type = &stmt->expr->type;
+			if (type->kind != AST_INTEGER_TYPE || type->width != 8 || type->pointer != 1) {
+				char *td = type_describe(type);
+				derror(&stmt->loc, "indirect goto requires a label address of type *int8, got %s instead\n", td);
+				free(td);
+			}
+			LLVMValueRef br = LLVMBuildIndirectBr(self->builder, addr, 4);
+			array_add(self->indirect_gotos, &br);
+			context->is_terminated = 1;
+			break;
+		}
+
+		case AST_UNCHECKED_STMT: {
+			codegen_t cg = *self;
+			cg.unchecked = 1;
+			if (stmt->body)
+				codegen_stmt(&cg, context, stmt->body);
+			break;
+		}
+
 		case AST_CONTINUE_STMT:
 			assert(self->continue_block && "nowhere to continue to");
 			LLVMBuildBr(self->builder, self->continue_block);
@@ -452,6 +949,35 @@ mangle_func_name(codegen_t *self, func_unit_t *func){
 	return strdup(str);
 }
 
+/// Returns whether a function's body is generated along with the
+/// declarations, and thus in every module that imports it.
+static int
+emit_with_decls(func_unit_t *func) {
+	return func->body && (func->is_const || (func->attrs & (AST_FUNC_INLINE | AST_FUNC_ALWAYS_INLINE)));
+}
+
+/// Maps the attributes given in front of a function declaration to the
+/// corresponding LLVM function attributes.
+static void
+add_func_attrs(LLVMValueRef func, unsigned attrs) {
+	static const struct { unsigned attr; const char *name; } map[] = {
+		{ AST_FUNC_INLINE,        "inlinehint" },
+		{ AST_FUNC_ALWAYS_INLINE, "alwaysinline" },
+		{ AST_FUNC_NOINLINE,      "noinline" },
+		{ AST_FUNC_HOT,           "hot" },
+		{ AST_FUNC_COLD,          "cold" },
+		{ AST_FUNC_PURE,          "readonly" },
+	};
+	LLVMContextRef ctx = LLVMGetModuleContext(LLVMGetGlobalParent(func));
+	unsigned i;
+	for (i = 0; i < sizeof(map)/sizeof(*map); ++i) {
+		if (!(attrs & map[i].attr))
+			continue;
+		unsigned kind = LLVMGetEnumAttributeKindForName(map[i].name, strlen(map[i].name));
+		LLVMAddAttributeAtIndex(func, LLVMAttributeFunctionIndex, LLVMCreateEnumAttribute(ctx, kind, 0));
+	}
+}
+
 static void
 codegen_unit (codegen_t *self, codegen_context_t *context, unit_t *unit, int stage) {
 	assert(self);
@@ -468,6 +994,8 @@ codegen_unit (codegen_t *self, codegen_context_t *context, unit_t *unit, int sta
 		case AST_DECL_UNIT:
 			if (stage == 1)
 				codegen_decl(self, context, unit->decl);
+			else if (stage == 2 && unit->decl->kind == AST_VARIABLE_DECL)
+				codegen_global_init(self, context, unit->decl);
 			break;
 
 		case AST_FUNC_UNIT: {
@@ -484,6 +1012,7 @@ codegen_unit (codegen_t *self, codegen_context_t *context, unit_t *unit, int sta
 				printf("fname: %s\n",fname);
 				// LLVMValueRef func = LLVMAddFunction(self->module, unit->func.name, func_type);
 				LLVMValueRef func = LLVMAddFunction(self->module, fname, func_type);
+				codegen_param_attrs(context, unit, func);
 
 				// Declare the function in the context.
 				type_t *type = &unit->func.type;
@@ -497,11 +1026,19 @@ codegen_unit (codegen_t *self, codegen_context_t *context, unit_t *unit, int sta
 					type_copy(type->func.args+i, &unit->func.params[i].type);
 				}
 
+				// Const and inline functions are generated in every module
+				// that imports them, such that they can be evaluated at
+				// compile time or inlined.
+				if (emit_with_decls(&unit->func))
+					LLVMSetLinkage(func, LLVMLinkOnceODRLinkage);
+				add_func_attrs(func, unit->func.attrs);
+
 				codegen_symbol_t sym = {
 					.kind = FUNC_SYMBOL,
 					.type = &unit->func.type,
 					.name = unit->func.name,
 					.value = func,
+					.func = &unit->func,
 				};
 				codegen_context_add_symbol(context, &sym);
 			} else if (stage == 2) {
@@ -521,6 +1058,26 @@ codegen_unit (codegen_t *self, codegen_context_t *context, unit_t *unit, int sta
 				cg.builder = builder;
 				cg.unit = unit;
 
+				// All stack slots are placed at the top of the entry block, in
+				// front of a marker instruction that is removed once the body
+				// has been generated.
+				LLVMValueRef alloca_marker = LLVMBuildAlloca(builder, LLVMInt1Type(), "");
+				cg.alloca_builder = LLVMCreateBuilder();
+				LLVMPositionBuilderBefore(cg.alloca_builder, alloca_marker);
+
+				array_t labels, indirect_gotos;
+				array_init(&labels, sizeof(codegen_label_t));
+				array_init(&indirect_gotos, sizeof(LLVMValueRef));
+				cg.labels = &labels;
+				cg.indirect_gotos = &indirect_gotos;
+
+				// Create the trap block shared by all runtime checks.
+				cg.trap_block = LLVMAppendBasicBlock(func, "trap");
+				LLVMPositionBuilderAtEnd(builder, cg.trap_block);
+				LLVMBuildCall(builder, LLVMGetIntrinsicByID(self->module, LLVMIntrinsicIDTrap, 0, 0), 0, 0, "");
+				LLVMBuildUnreachable(builder);
+				LLVMPositionBuilderAtEnd(builder, block);
+
 				context_t subctx;
 				codegen_context_init(&subctx);
 				subctx.prev = context;
@@ -532,8 +1089,8 @@ codegen_unit (codegen_t *self, codegen_context_t *context, unit_t *unit, int sta
 					if (param->name)
 						LLVMSetValueName(param_value, param->name);
 
-					LLVMValueRef var = LLVMBuildAlloca(builder, codegen_type(context, &param->type), "");
-					LLVMBuildStore(builder, param_value, var);
+					LLVMValueRef var = codegen_alloca(&cg, codegen_type(context, &param->type), "");
+					codegen_store(&cg, context, param_value, var, &param->type, 0);
 
 					codegen_symbol_t sym = {
 						.name = param->name,
@@ -554,6 +1111,31 @@ codegen_unit (codegen_t *self, codegen_context_t *context, unit_t *unit, int sta
 
 				// LLVMBuildRetVoid(builder);
 				LLVMDisposeBuilder(builder);
+				LLVMDisposeBuilder(cg.alloca_builder);
+				LLVMInstructionEraseFromParent(alloca_marker);
+
+				// Make sure every label jumped to is defined, and allow each
+				// indirect goto to reach any label whose address is taken.
+				for (i = 0; i < labels.size; ++i) {
+					codegen_label_t *label = array_get(&labels, i);
+					if (!label->defined)
+						derror(&label->loc, "label '%s' is not defined in '%s'\n", label->name, unit->func.name);
+					unsigned n;
+					for (n = 0; n < indirect_gotos.size && label->address_taken; ++n)
+						LLVMAddDestination(*(LLVMValueRef*)array_get(&indirect_gotos, n), label->block);
+					free(label->name);
+				}
+				array_dispose(&labels);
+				array_dispose(&indirect_gotos);
+
+				// Move the trap block out of the way of the hot code, or drop
+				// it if there are no runtime checks.
+				if (LLVMGetFirstUse(LLVMBasicBlockAsValue(cg.trap_block)))
+					LLVMMoveBasicBlockAfter(cg.trap_block, LLVMGetLastBasicBlock(func));
+				else
+					LLVMDeleteBasicBlock(cg.trap_block);
+
+				codegen_alias_func(context, unit, func);
 
 				// Verify that the function is well-formed.
 				LLVMBool failed = LLVMVerifyFunction(func, LLVMPrintMessageAction);
@@ -561,6 +1143,15 @@ codegen_unit (codegen_t *self, codegen_context_t *context, unit_t *unit, int sta
 					fprintf(stderr, "Function %s contained errors, exiting\n", unit->func.name);
 					exit(1);
 				}
+
+				// Promote the stack slots of variables whose address is never
+				// taken to SSA values.
+				LLVMPassManagerRef fpm = LLVMCreateFunctionPassManagerForModule(self->module);
+				LLVMAddPromoteMemoryToRegisterPass(fpm);
+				LLVMInitializeFunctionPassManager(fpm);
+				LLVMRunFunctionPassManager(fpm, func);
+				LLVMFinalizeFunctionPassManager(fpm);
+				LLVMDisposePassManager(fpm);
 			}
 			break;
 		}
@@ -595,6 +1186,23 @@ codegen_decls (codegen_t *self, codegen_context_t *context, const array_t *units
 		codegen_unit(self, context, array_get(units,i), 0);
 	for (i = 0; i < units->size; ++i)
 		codegen_unit(self, context, array_get(units,i), 1);
+
+	// Generate the bodies of const and inline functions right away, such that
+	// const functions may be evaluated by the const declarations deferred in
+	// codegen_decl, and importing modules get a copy of them.
+	for (i = 0; i < units->size; ++i) {
+		unit_t *unit = array_get(units,i);
+		if (unit->kind == AST_FUNC_UNIT && emit_with_decls(&unit->func))
+			codegen_unit(self, context, unit, 2);
+	}
+	for (i = 0; i < units->size; ++i) {
+		unit_t *unit = array_get(units,i);
+		if (unit->kind != AST_DECL_UNIT || unit->decl->kind != AST_CONST_DECL)
+			continue;
+		codegen_symbol_t *sym = codegen_context_find_symbol(context, unit->decl->cons.name);
+		if (sym && sym->decl == unit->decl && sym->value && !LLVMGetInitializer(sym->value))
+			codegen_const_init(self, context, unit->decl, sym->value);
+	}
 }
 
 
@@ -605,8 +1213,11 @@ codegen_defs (codegen_t *self, codegen_context_t *context, const array_t *units)
 	assert(units);
 
 	unsigned i;
-	for (i = 0; i < units->size; ++i)
-		codegen_unit(self, context, array_get(units,i), 2);
+	for (i = 0; i < units->size; ++i) {
+		unit_t *unit = array_get(units,i);
+		if (unit->kind != AST_FUNC_UNIT || !emit_with_decls(&unit->func))
+			codegen_unit(self, context, unit, 2);
+	}
 }
 
 void
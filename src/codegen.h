@@ -3,19 +3,95 @@
 #include "array.h"
 #include "ast.h"
 #include <llvm-c/Core.h>
+#include <llvm-c/Target.h>
 
 typedef struct codegen codegen_t;
 typedef struct codegen_context codegen_context_t;
 typedef struct codegen_symbol codegen_symbol_t;
+typedef struct bounds_fact bounds_fact_t;
+typedef struct codegen_switch codegen_switch_t;
+typedef struct codegen_label codegen_label_t;
+typedef struct codegen_bitfield codegen_bitfield_t;
 
 struct codegen {
 	LLVMModuleRef module;
 	LLVMValueRef func;
 	LLVMBuilderRef builder;
+	/// Builder positioned at the top of the current function's entry block,
+	/// where codegen_alloca places all stack slots.
+	LLVMBuilderRef alloca_builder;
 	LLVMBasicBlockRef break_block;
 	LLVMBasicBlockRef continue_block;
 	unit_t *unit;
 	package_unit_t *package;
+	bounds_fact_t *bounds_facts;
+	/// Innermost switch statement whose body is being generated, or null.
+	codegen_switch_t *switch_stmt;
+	/// Labels of the current function, created as goto statements and label
+	/// addresses refer to them. See codegen_label.
+	array_t *labels;
+	/// Indirect goto instructions of the current function. Once the body is
+	/// complete, every label whose address is taken becomes a destination.
+	array_t *indirect_gotos;
+	/// Block of the current function that all failing runtime checks branch
+	/// to. It traps and is removed again if no check uses it.
+	LLVMBasicBlockRef trap_block;
+	/// Set within `unchecked` blocks, where no runtime checks are emitted.
+	unsigned unchecked;
+	/// Set while generating the value of a const declaration, where calls to
+	/// const functions are evaluated at compile time.
+	unsigned const_eval;
+};
+
+/// States that the local integer variable \a index stays within [start,bound)
+/// throughout the body of \a loop, where \a bound is loop invariant. Indexing
+/// with it into the local slice variable \a slice, whose length is the bound,
+/// is within bounds. Other slices are checked once against the bound in the
+/// \a guard block ahead of the loop, and recorded in \a checked. This needs
+/// the access to be emitted into the \a straight block, which is entered at the
+/// top of the body, in a loop that no statement \a leaves early. See
+/// codegen_bounds.c.
+struct bounds_fact {
+	LLVMValueRef index;
+	LLVMValueRef slice;
+	stmt_t *loop;
+	codegen_context_t *context;
+	expr_t *bound;
+	long long start;
+	int leaves;
+	LLVMBasicBlockRef guard;
+	LLVMBasicBlockRef straight;
+	array_t checked;
+	bounds_fact_t *prev;
+};
+
+/// State of a switch statement that its case and default labels add to.
+struct codegen_switch {
+	LLVMValueRef inst;
+	type_t *type;
+	LLVMBasicBlockRef default_block;
+	unsigned has_default;
+	array_t values;
+};
+
+/// A label that goto statements may jump to.
+struct codegen_label {
+	char *name;
+	LLVMBasicBlockRef block;
+	loc_t loc;
+	unsigned defined;
+	unsigned address_taken;
+};
+
+/// A bitfield member of a struct, as located by codegen_bitfield.
+struct codegen_bitfield {
+	/// Pointer to the integer field that holds the bitfield.
+	LLVMValueRef ptr;
+	unsigned shift;
+	unsigned bits;
+	unsigned is_signed;
+	/// Alignment of the field as returned by codegen_member_align.
+	unsigned align;
 };
 
 struct codegen_context {
@@ -39,6 +115,8 @@ struct codegen_symbol {
 	decl_t *decl;
 	type_t *interface;
 	unsigned member;
+	/// The declaration of a function symbol.
+	func_unit_t *func;
 };
 
 
@@ -54,9 +132,41 @@ codegen_symbol_t *codegen_context_find_symbol(codegen_context_t *self, const cha
 const char *codegen_context_find_mapping(codegen_context_t *self, type_t *interface, type_t *target, const char *name);
 type_t *resolve_type_name(codegen_context_t *context, type_t *type);
 
+void codegen_param_attrs(codegen_context_t *context, unit_t *unit, LLVMValueRef func);
+void codegen_alias_func(codegen_context_t *context, unit_t *unit, LLVMValueRef func);
+
+int codegen_bounds_loop_fact(codegen_t *self, codegen_context_t *context, stmt_t *stmt, bounds_fact_t *fact);
+int codegen_bounds_known(codegen_t *self, codegen_context_t *context, expr_t *target, expr_t *index);
+void codegen_check(codegen_t *self, LLVMValueRef cond, loc_t *loc, LLVMValueRef index);
+
+void codegen_const_eval(codegen_context_t *context, expr_t *expr);
+LLVMValueRef codegen_const_value(codegen_context_t *context, expr_t *expr);
+int codegen_const_unary(unsigned op, type_t *type, const const_value_t *a, const_value_t *out);
+int codegen_const_binary(unsigned op, type_t *type, const const_value_t *a, const const_value_t *b, const_value_t *out);
+int codegen_const_cast(type_t *from, type_t *to, const const_value_t *a, const_value_t *out);
+int codegen_const_intrinsic(unsigned op, type_t *type, const const_value_t *args, const_value_t *out);
+
+LLVMValueRef codegen_interp_call(codegen_context_t *context, expr_t *call);
+
 LLVMTypeRef codegen_type(codegen_context_t *context, type_t *type);
+unsigned codegen_type_align(codegen_context_t *context, type_t *type);
+unsigned codegen_struct_field(codegen_context_t *context, type_t *type, unsigned index);
+unsigned codegen_struct_shift(codegen_context_t *context, type_t *type, unsigned index);
+unsigned codegen_member_align(codegen_context_t *context, expr_t *expr);
+int codegen_bitfield(codegen_t *self, codegen_context_t *context, expr_t *expr, codegen_bitfield_t *bf);
+LLVMValueRef codegen_bitfield_load(codegen_t *self, codegen_bitfield_t *bf);
+void codegen_bitfield_store(codegen_t *self, codegen_bitfield_t *bf, LLVMValueRef value);
+LLVMTargetDataRef codegen_target_data(void);
+void codegen_set_target(LLVMModuleRef module);
+LLVMValueRef codegen_alloca(codegen_t *self, LLVMTypeRef type, const char *name);
+LLVMValueRef codegen_load(codegen_t *self, codegen_context_t *context, LLVMValueRef ptr, type_t *type, unsigned align);
+LLVMValueRef codegen_store(codegen_t *self, codegen_context_t *context, LLVMValueRef value, LLVMValueRef ptr, type_t *type, unsigned align);
+LLVMValueRef codegen_memory_const(codegen_context_t *context, LLVMValueRef value, type_t *type);
+LLVMValueRef codegen_splat(codegen_t *self, LLVMValueRef value, unsigned length);
+codegen_label_t *codegen_label(codegen_t *self, const char *name, loc_t *loc);
 void prepare_expr(codegen_t *self, codegen_context_t *context, expr_t *expr, type_t *type_hint);
 LLVMValueRef codegen_expr(codegen_t *self, codegen_context_t *context, expr_t *expr, char lvalue, type_t *type_hint);
+void codegen_cond_br(codegen_t *self, codegen_context_t *context, expr_t *cond, LLVMBasicBlockRef true_block, LLVMBasicBlockRef false_block);
 
 void codegen_decls(codegen_t *self, codegen_context_t *context, const array_t *units);
 void codegen_defs(codegen_t *self, codegen_context_t *context, const array_t *units);
@@ -0,0 +1,194 @@
+#include "codegen_internal.h"
+
+/*
+ * Aliasing information for function parameters. A parameter declared as
+ * `restrict` promises that the memory it refers to is not accessed through
+ * any other parameter while the function runs:
+ *
+ *     func scale (restrict dst []float32, restrict src []float32, k float32) void
+ *
+ * Restrict pointers are marked `noalias`. Slices are passed by value and carry
+ * their data pointer inside, so instead every load and store through a
+ * restrict slice is tagged with an alias scope of its own, and declared not to
+ * alias the scopes of the other restrict slices.
+ *
+ * Pointer parameters that are only ever read through are marked `readonly`
+ * and `nocapture` once the body has been generated.
+ */
+
+
+static void
+add_param_attr(LLVMValueRef func, unsigned index, const char *name) {
+	LLVMContextRef ctx = LLVMGetModuleContext(LLVMGetGlobalParent(func));
+	unsigned kind = LLVMGetEnumAttributeKindForName(name, strlen(name));
+	LLVMAddAttributeAtIndex(func, index+1, LLVMCreateEnumAttribute(ctx, kind, 0));
+}
+
+
+/*
+ * Checks the restrict qualifiers of a function's parameters, and marks the
+ * restrict pointers as `noalias` in the function's declaration.
+ */
+void
+codegen_param_attrs(codegen_context_t *context, unit_t *unit, LLVMValueRef func) {
+	unsigned i;
+	for (i = 0; i < unit->func.num_params; ++i) {
+		func_param_t *param = unit->func.params + i;
+		if (!param->noalias)
+			continue;
+		type_t *type = resolve_type_name(context, &param->type);
+		if (type->kind == AST_FUNC_TYPE || (type->pointer == 0 && type->kind != AST_SLICE_TYPE))
+			derror(&unit->loc, "restrict parameter '%s' of '%s' must be a pointer or a slice\n", param->name, unit->func.name);
+		if (type->pointer > 0)
+			add_param_attr(func, i, "noalias");
+	}
+}
+
+
+/*
+ * Returns the stack slot a parameter is stored to on entry, or null if the
+ * slot is written to anywhere else or its address escapes.
+ */
+static LLVMValueRef
+param_slot(LLVMValueRef param) {
+	LLVMUseRef use = LLVMGetFirstUse(param);
+	if (!use || LLVMGetNextUse(use))
+		return 0;
+	LLVMValueRef store = LLVMGetUser(use);
+	if (!LLVMIsAStoreInst(store) || LLVMGetOperand(store, 0) != param)
+		return 0;
+	LLVMValueRef slot = LLVMGetOperand(store, 1);
+	if (!LLVMIsAAllocaInst(slot))
+		return 0;
+	for (use = LLVMGetFirstUse(slot); use; use = LLVMGetNextUse(use)) {
+		LLVMValueRef user = LLVMGetUser(use);
+		if (user != store && !LLVMIsALoadInst(user))
+			return 0;
+	}
+	return slot;
+}
+
+/// Returns whether \a ptr and the pointers derived from it are only loaded
+/// from.
+static int
+only_loaded(LLVMValueRef ptr) {
+	LLVMUseRef use;
+	for (use = LLVMGetFirstUse(ptr); use; use = LLVMGetNextUse(use)) {
+		LLVMValueRef user = LLVMGetUser(use);
+		if (LLVMIsALoadInst(user))
+			continue;
+		if ((LLVMIsAGetElementPtrInst(user) || LLVMIsABitCastInst(user)) &&
+		    LLVMGetOperand(user, 0) == ptr && only_loaded(user))
+			continue;
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Returns the index of the slice in \a slots whose data pointer \a ptr is
+ * derived from, or -1 if there is none.
+ */
+static int
+find_slice(LLVMValueRef ptr, LLVMValueRef *slots, unsigned num_slots) {
+	for (;;) {
+		if (LLVMIsAGetElementPtrInst(ptr) || LLVMIsABitCastInst(ptr))
+			ptr = LLVMGetOperand(ptr, 0);
+		else if (LLVMIsAExtractValueInst(ptr) && LLVMGetNumIndices(ptr) == 1 && LLVMGetIndices(ptr)[0] == 0)
+			ptr = LLVMGetOperand(ptr, 0);
+		else
+			break;
+	}
+	if (!LLVMIsALoadInst(ptr))
+		return -1;
+	LLVMValueRef slot = LLVMGetOperand(ptr, 0);
+	unsigned i;
+	for (i = 0; i < num_slots; ++i)
+		if (slots[i] && slots[i] == slot)
+			return i;
+	return -1;
+}
+
+/*
+ * Tags the memory accesses through restrict slices with alias scopes, and
+ * marks pointer parameters that are only read through as `readonly`. Called
+ * once the body of the function has been generated.
+ */
+void
+codegen_alias_func(codegen_context_t *context, unit_t *unit, LLVMValueRef func) {
+	unsigned i, n = unit->func.num_params;
+	LLVMValueRef slices[n];
+	unsigned num_slices = 0;
+
+	for (i = 0; i < n; ++i) {
+		func_param_t *param = unit->func.params + i;
+		type_t *type = resolve_type_name(context, &param->type);
+		LLVMValueRef slot = param_slot(LLVMGetParam(func, i));
+		slices[i] = 0;
+		if (!slot)
+			continue;
+
+		if (type->pointer > 0 && type->kind != AST_FUNC_TYPE) {
+			LLVMUseRef use;
+			for (use = LLVMGetFirstUse(slot); use; use = LLVMGetNextUse(use)) {
+				LLVMValueRef user = LLVMGetUser(use);
+				if (LLVMIsALoadInst(user) && !only_loaded(user))
+					break;
+			}
+			if (!use) {
+				add_param_attr(func, i, "readonly");
+				add_param_attr(func, i, "nocapture");
+			}
+		} else if (param->noalias && type->pointer == 0 && type->kind == AST_SLICE_TYPE) {
+			slices[i] = slot;
+			++num_slices;
+		}
+	}
+	if (num_slices == 0)
+		return;
+
+	// Each restrict slice gets a scope within a domain private to the
+	// function.
+	const char *fname = LLVMGetValueName(func);
+	LLVMValueRef domain_name = LLVMMDString(fname, strlen(fname));
+	LLVMValueRef domain = LLVMMDNode(&domain_name, 1);
+	LLVMValueRef scopes[n];
+	for (i = 0; i < n; ++i) {
+		scopes[i] = 0;
+		if (!slices[i])
+			continue;
+		char *name;
+		asprintf(&name, "%s: %s", fname, unit->func.params[i].name);
+		LLVMValueRef ops[2] = { LLVMMDString(name, strlen(name)), domain };
+		scopes[i] = LLVMMDNode(ops, 2);
+		free(name);
+	}
+
+	unsigned scope_kind = LLVMGetMDKindID("alias.scope", 11);
+	unsigned noalias_kind = LLVMGetMDKindID("noalias", 7);
+	LLVMBasicBlockRef bb;
+	LLVMValueRef inst;
+	for (bb = LLVMGetFirstBasicBlock(func); bb; bb = LLVMGetNextBasicBlock(bb)) {
+		for (inst = LLVMGetFirstInstruction(bb); inst; inst = LLVMGetNextInstruction(inst)) {
+			LLVMValueRef ptr;
+			if (LLVMIsALoadInst(inst))
+				ptr = LLVMGetOperand(inst, 0);
+			else if (LLVMIsAStoreInst(inst))
+				ptr = LLVMGetOperand(inst, 1);
+			else
+				continue;
+			int slice = find_slice(ptr, slices, n);
+			if (slice < 0)
+				continue;
+
+			LLVMValueRef others[n];
+			unsigned k, num_others = 0;
+			for (k = 0; k < n; ++k)
+				if (scopes[k] && k != (unsigned)slice)
+					others[num_others++] = scopes[k];
+			LLVMSetMetadata(inst, scope_kind, LLVMMDNode(scopes + slice, 1));
+			if (num_others > 0)
+				LLVMSetMetadata(inst, noalias_kind, LLVMMDNode(others, num_others));
+		}
+	}
+}
@@ -17,29 +17,39 @@ PREPARE_EXPR(assignment_expr) {
 
 
 CODEGEN_EXPR(assignment_expr) {
-	LLVMValueRef lv = codegen_expr(self, context, expr->assignment.target, 1, 0);
+	codegen_bitfield_t bf;
+	int is_bitfield = codegen_bitfield(self, context, expr->assignment.target, &bf);
+	LLVMValueRef lv = is_bitfield ? bf.ptr : codegen_expr(self, context, expr->assignment.target, 1, 0);
 	if (!lv) {
 		fprintf(stderr, "expr %d cannot be assigned a value\n", expr->assignment.target->kind);
 		abort();
 		return 0;
 	}
+	unsigned align = codegen_member_align(context, expr->assignment.target);
 	LLVMValueRef rv = codegen_expr(self, context, expr->assignment.expr, 0, 0);
 	LLVMValueRef v;
 	if (expr->assignment.op == AST_ASSIGN) {
 		v = rv;
 	} else {
-		LLVMValueRef dv = LLVMBuildLoad(self->builder, lv, "");
+		LLVMValueRef dv = is_bitfield ? codegen_bitfield_load(self, &bf) : codegen_load(self, context, lv, &expr->assignment.target->type, align);
+		type_t *t = resolve_type_name(context, &expr->assignment.target->type);
+		int u = t->pointer == 0 && t->kind == AST_INTEGER_TYPE && t->is_unsigned;
 		switch (expr->assignment.op) {
 			case AST_ADD_ASSIGN: v = LLVMBuildAdd(self->builder, dv, rv, ""); break;
 			case AST_SUB_ASSIGN: v = LLVMBuildSub(self->builder, dv, rv, ""); break;
 			case AST_MUL_ASSIGN: v = LLVMBuildMul(self->builder, dv, rv, ""); break;
-			case AST_DIV_ASSIGN: v = LLVMBuildUDiv(self->builder, dv, rv, ""); break;
+			case AST_DIV_ASSIGN:
+				v = u ? LLVMBuildUDiv(self->builder, dv, rv, "") : LLVMBuildSDiv(self->builder, dv, rv, "");
+				break;
 			default:
 				fprintf(stderr, "%s.%d: codegen for assignment op %d not implemented\n", __FILE__, __LINE__, expr->assignment.op);
 				abort();
 				return 0;
 		}
 	}
-	LLVMBuildStore(self->builder, v, lv);
+	if (is_bitfield)
+		codegen_bitfield_store(self, &bf, v);
+	else
+		codegen_store(self, context, v, lv, &expr->assignment.target->type, align);
 	return rv;
 }
@@ -0,0 +1,170 @@
+#include "codegen_internal.h"
+
+/*
+ * The atomic() builtin, which lowers to LLVM's atomic instructions:
+ *
+ *     atomic(load, p [, order])                  evaluates to *p
+ *     atomic(store, p, v [, order])
+ *     atomic(xchg|add|sub|and|or|xor|min|max, p, v [, order])
+ *     atomic(cmpxchg, p, expected, desired [, order])
+ *     atomic(fence [, order])
+ *
+ * Read-modify-write operations and cmpxchg evaluate to the value *p held
+ * before the operation; a cmpxchg succeeded if that value equals `expected`.
+ */
+
+
+static const char *op_names[] = {
+	[AST_ATOMIC_LOAD]    = "load",
+	[AST_ATOMIC_STORE]   = "store",
+	[AST_ATOMIC_XCHG]    = "xchg",
+	[AST_ATOMIC_ADD]     = "add",
+	[AST_ATOMIC_SUB]     = "sub",
+	[AST_ATOMIC_AND]     = "and",
+	[AST_ATOMIC_OR]      = "or",
+	[AST_ATOMIC_XOR]     = "xor",
+	[AST_ATOMIC_MIN]     = "min",
+	[AST_ATOMIC_MAX]     = "max",
+	[AST_ATOMIC_CMPXCHG] = "cmpxchg",
+	[AST_ATOMIC_FENCE]   = "fence",
+};
+
+static const char *order_names[] = {
+	[AST_ATOMIC_SEQ_CST] = "seq_cst",
+	[AST_ATOMIC_RELAXED] = "relaxed",
+	[AST_ATOMIC_ACQUIRE] = "acquire",
+	[AST_ATOMIC_RELEASE] = "release",
+	[AST_ATOMIC_ACQ_REL] = "acq_rel",
+};
+
+
+PREPARE_EXPR(atomic_builtin_expr) {
+	unsigned op = expr->atomic.op;
+	unsigned order = expr->atomic.order;
+	expr_t *args = expr->atomic.args;
+
+	// Loads cannot release, stores cannot acquire, and a relaxed fence does
+	// not order anything.
+	if ((op == AST_ATOMIC_LOAD && (order == AST_ATOMIC_RELEASE || order == AST_ATOMIC_ACQ_REL)) ||
+	    (op == AST_ATOMIC_STORE && (order == AST_ATOMIC_ACQUIRE || order == AST_ATOMIC_ACQ_REL)) ||
+	    (op == AST_ATOMIC_FENCE && order == AST_ATOMIC_RELAXED))
+		derror(&expr->loc, "memory ordering %s is not valid for atomic %s\n", order_names[order], op_names[op]);
+
+	bzero(&expr->type, sizeof expr->type);
+	expr->type.kind = AST_VOID_TYPE;
+	if (op == AST_ATOMIC_FENCE)
+		return;
+
+	prepare_expr(self, context, args, 0);
+	type_t *ptr_type = resolve_type_name(context, &args[0].type);
+	if (ptr_type->pointer == 0 || ptr_type->kind == AST_FUNC_TYPE) {
+		char *td = type_describe(&args[0].type);
+		derror(&args[0].loc, "atomic %s requires a pointer, got %s\n", op_names[op], td);
+		free(td);
+	}
+	type_t value_type;
+	type_copy(&value_type, ptr_type);
+	--value_type.pointer;
+
+	// Integers of 8 to 64 bits in native byte order may be used with all operations, pointers only
+	// be loaded, stored, and compared and exchanged.
+	type_t *vt = resolve_type_name(context, &value_type);
+	int is_int = vt->pointer == 0 && vt->kind == AST_INTEGER_TYPE && vt->byte_order == AST_NATIVE_ORDER &&
+		vt->width >= 8 && vt->width <= 64 && (vt->width & (vt->width - 1)) == 0;
+	int is_ptr = vt->pointer > 0 && vt->kind != AST_FUNC_TYPE;
+	if (!is_int && !(is_ptr && (op == AST_ATOMIC_LOAD || op == AST_ATOMIC_STORE || op == AST_ATOMIC_CMPXCHG))) {
+		char *td = type_describe(&value_type);
+		derror(&args[0].loc, "atomic %s not available for %s\n", op_names[op], td);
+		free(td);
+	}
+
+	unsigned i;
+	for (i = 1; i < expr->atomic.num_args; ++i) {
+		prepare_expr(self, context, args+i, &value_type);
+		if (!type_equal(&args[i].type, &value_type)) {
+			char *t1 = type_describe(&value_type);
+			char *t2 = type_describe(&args[i].type);
+			derror(&args[i].loc, "atomic %s on %s requires an operand of the same type, got %s\n", op_names[op], t1, t2);
+			free(t1);
+			free(t2);
+		}
+	}
+
+	if (op != AST_ATOMIC_STORE)
+		type_copy(&expr->type, &value_type);
+	type_dispose(&value_type);
+}
+
+
+static LLVMAtomicOrdering
+llvm_ordering(unsigned order) {
+	switch (order) {
+		case AST_ATOMIC_RELAXED: return LLVMAtomicOrderingMonotonic;
+		case AST_ATOMIC_ACQUIRE: return LLVMAtomicOrderingAcquire;
+		case AST_ATOMIC_RELEASE: return LLVMAtomicOrderingRelease;
+		case AST_ATOMIC_ACQ_REL: return LLVMAtomicOrderingAcquireRelease;
+		default:                 return LLVMAtomicOrderingSequentiallyConsistent;
+	}
+}
+
+CODEGEN_EXPR(atomic_builtin_expr) {
+	assert(!lvalue && "result of atomic is not a valid lvalue");
+	unsigned op = expr->atomic.op;
+	LLVMAtomicOrdering order = llvm_ordering(expr->atomic.order);
+	if (op == AST_ATOMIC_FENCE)
+		return LLVMBuildFence(self->builder, order, 0, "");
+
+	expr_t *args = expr->atomic.args;
+	LLVMValueRef ptr = codegen_expr(self, context, args, 0, 0);
+	LLVMValueRef values[2] = { 0, 0 };
+	unsigned i;
+	for (i = 1; i < expr->atomic.num_args; ++i)
+		values[i-1] = codegen_expr(self, context, args+i, 0, 0);
+
+	// Atomic accesses must be naturally aligned.
+	LLVMTargetDataRef layout = LLVMGetModuleDataLayout(self->module);
+	unsigned size = LLVMABISizeOfType(layout, LLVMGetElementType(LLVMTypeOf(ptr)));
+
+	LLVMValueRef inst;
+	switch (op) {
+		case AST_ATOMIC_LOAD:
+			inst = LLVMBuildLoad(self->builder, ptr, "");
+			LLVMSetOrdering(inst, order);
+			LLVMSetAlignment(inst, size);
+			return inst;
+		case AST_ATOMIC_STORE:
+			inst = LLVMBuildStore(self->builder, values[0], ptr);
+			LLVMSetOrdering(inst, order);
+			LLVMSetAlignment(inst, size);
+			return inst;
+		case AST_ATOMIC_CMPXCHG: {
+			// A failed exchange only loads, so it cannot release.
+			LLVMAtomicOrdering failure = order;
+			if (order == LLVMAtomicOrderingAcquireRelease)
+				failure = LLVMAtomicOrderingAcquire;
+			else if (order == LLVMAtomicOrderingRelease)
+				failure = LLVMAtomicOrderingMonotonic;
+			inst = LLVMBuildAtomicCmpXchg(self->builder, ptr, values[0], values[1], order, failure, 0);
+			return LLVMBuildExtractValue(self->builder, inst, 0, "");
+		}
+		default:
+			break;
+	}
+
+	type_t *t = resolve_type_name(context, &expr->type);
+	LLVMAtomicRMWBinOp rmw;
+	switch (op) {
+		case AST_ATOMIC_XCHG: rmw = LLVMAtomicRMWBinOpXchg; break;
+		case AST_ATOMIC_ADD:  rmw = LLVMAtomicRMWBinOpAdd;  break;
+		case AST_ATOMIC_SUB:  rmw = LLVMAtomicRMWBinOpSub;  break;
+		case AST_ATOMIC_AND:  rmw = LLVMAtomicRMWBinOpAnd;  break;
+		case AST_ATOMIC_OR:   rmw = LLVMAtomicRMWBinOpOr;   break;
+		case AST_ATOMIC_XOR:  rmw = LLVMAtomicRMWBinOpXor;  break;
+		case AST_ATOMIC_MIN:  rmw = t->is_unsigned ? LLVMAtomicRMWBinOpUMin : LLVMAtomicRMWBinOpMin; break;
+		case AST_ATOMIC_MAX:  rmw = t->is_unsigned ? LLVMAtomicRMWBinOpUMax : LLVMAtomicRMWBinOpMax; break;
+		default:
+			die("unexpected atomic operation %d", op);
+			return 0;
+	}
+	return LLVMBuildAtomicRMW(self->builder, rmw, ptr, values[0], order, 0);
+}
@@ -40,10 +40,19 @@ PREPARE_EXPR(binary_expr) {
 		case AST_EQ:
 		case AST_NE:
 		case AST_AND:
-		case AST_OR:
+		case AST_OR: {
+			// Comparing vectors yields a vector of booleans.
+			type_t *lhs_type = resolve_type_name(context, &expr->binary_op.lhs->type);
 			bzero(&expr->type, sizeof expr->type);
 			expr->type.kind = AST_BOOLEAN_TYPE;
-			break;
+			if (lhs_type->pointer == 0 && lhs_type->kind == AST_VECTOR_TYPE) {
+				type_t *lane = malloc(sizeof(type_t));
+				*lane = expr->type;
+				expr->type.kind = AST_VECTOR_TYPE;
+				expr->type.vector.type = lane;
+				expr->type.vector.length = lhs_type->vector.length;
+			}
+		} break;
 		default:
 			type_copy(&expr->type, &expr->binary_op.lhs->type);
 			break;
@@ -51,6 +60,77 @@ PREPARE_EXPR(binary_expr) {
 }
 
 
+static int
+is_logical_op(expr_t *expr) {
+	return expr->kind == AST_BINARY_EXPR &&
+		(expr->binary_op.op == AST_AND || expr->binary_op.op == AST_OR) &&
+		expr->binary_op.lhs->type.kind == AST_BOOLEAN_TYPE &&
+		expr->binary_op.rhs->type.kind == AST_BOOLEAN_TYPE;
+}
+
+
+/*
+ * Branches to one of two blocks depending on a prepared boolean condition.
+ * Conditions built from `&&`, `||`, and `!` are lowered directly to a tree of
+ * branches, without computing the value of the condition.
+ */
+void
+codegen_cond_br(codegen_t *self, codegen_context_t *context, expr_t *cond, LLVMBasicBlockRef true_block, LLVMBasicBlockRef false_block) {
+	if (is_logical_op(cond)) {
+		LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(self->builder));
+		LLVMBasicBlockRef rhs_block;
+		if (cond->binary_op.op == AST_AND) {
+			rhs_block = LLVMAppendBasicBlock(func, "andrhs");
+			codegen_cond_br(self, context, cond->binary_op.lhs, rhs_block, false_block);
+		} else {
+			rhs_block = LLVMAppendBasicBlock(func, "orrhs");
+			codegen_cond_br(self, context, cond->binary_op.lhs, true_block, rhs_block);
+		}
+		LLVMPositionBuilderAtEnd(self->builder, rhs_block);
+		codegen_cond_br(self, context, cond->binary_op.rhs, true_block, false_block);
+	} else if (cond->kind == AST_UNARY_EXPR && cond->unary_op.op == AST_NOT &&
+	           cond->unary_op.target->type.kind == AST_BOOLEAN_TYPE) {
+		codegen_cond_br(self, context, cond->unary_op.target, false_block, true_block);
+	} else if (cond->constant.known) {
+		LLVMBuildBr(self->builder, cond->constant.i ? true_block : false_block);
+	} else {
+		LLVMValueRef value = codegen_expr(self, context, cond, 0, 0);
+		LLVMBuildCondBr(self->builder, value, true_block, false_block);
+	}
+}
+
+
+/*
+ * Evaluates `a && b` or `a || b` such that b is only evaluated if a does not
+ * already determine the result.
+ */
+static LLVMValueRef
+codegen_logical_op(codegen_t *self, codegen_context_t *context, expr_t *expr) {
+	LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(self->builder));
+	LLVMBasicBlockRef rhs_block = LLVMAppendBasicBlock(func, expr->binary_op.op == AST_AND ? "andrhs" : "orrhs");
+	LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(func, expr->binary_op.op == AST_AND ? "andexit" : "orexit");
+
+	LLVMValueRef lhs = codegen_expr(self, context, expr->binary_op.lhs, 0, 0);
+	LLVMBasicBlockRef lhs_block = LLVMGetInsertBlock(self->builder);
+	if (expr->binary_op.op == AST_AND)
+		LLVMBuildCondBr(self->builder, lhs, rhs_block, exit_block);
+	else
+		LLVMBuildCondBr(self->builder, lhs, exit_block, rhs_block);
+
+	LLVMPositionBuilderAtEnd(self->builder, rhs_block);
+	LLVMValueRef rhs = codegen_expr(self, context, expr->binary_op.rhs, 0, 0);
+	rhs_block = LLVMGetInsertBlock(self->builder);
+	LLVMBuildBr(self->builder, exit_block);
+
+	LLVMPositionBuilderAtEnd(self->builder, exit_block);
+	LLVMValueRef phi = LLVMBuildPhi(self->builder, LLVMInt1Type(), "");
+	LLVMValueRef values[2] = { LLVMConstInt(LLVMInt1Type(), expr->binary_op.op == AST_OR, 0), rhs };
+	LLVMBasicBlockRef blocks[2] = { lhs_block, rhs_block };
+	LLVMAddIncoming(phi, values, blocks, 2);
+	return phi;
+}
+
+
 CODEGEN_EXPR(binary_expr) {
 	if (expr->binary_op.lhs->type.kind == AST_NO_TYPE &&
 		expr->binary_op.rhs->type.kind == AST_NO_TYPE)
@@ -65,10 +145,17 @@ CODEGEN_EXPR(binary_expr) {
 	}
 
 	assert(!lvalue && "result of a binary operation is not a valid lvalue");
+	if (is_logical_op(expr))
+		return codegen_logical_op(self, context, expr);
+
 	LLVMValueRef lhs = codegen_expr(self, context, expr->binary_op.lhs, 0, 0);
 	LLVMValueRef rhs = codegen_expr(self, context, expr->binary_op.rhs, 0, 0);
 
-	type_t *t = &expr->binary_op.lhs->type;
+	// Vectors are operated on lane by lane.
+	type_t *t = resolve_type_name(context, &expr->binary_op.lhs->type);
+	if (t->pointer == 0 && t->kind == AST_VECTOR_TYPE)
+		t = resolve_type_name(context, t->vector.type);
+
 	if (t->kind == AST_BOOLEAN_TYPE) {
 		switch (expr->binary_op.op) {
 			case AST_EQ:
@@ -76,14 +163,19 @@ CODEGEN_EXPR(binary_expr) {
 			case AST_NE:
 				return LLVMBuildICmp(self->builder, LLVMIntNE, lhs, rhs, "");
 			case AST_AND:
+			case AST_BITWISE_AND:
 				return LLVMBuildAnd(self->builder, lhs, rhs, "");
 			case AST_OR:
+			case AST_BITWISE_OR:
 				return LLVMBuildOr(self->builder, lhs, rhs, "");
+			case AST_BITWISE_XOR:
+				return LLVMBuildXor(self->builder, lhs, rhs, "");
 			default:
 				fprintf(stderr, "%s.%d: codegen for binary op %d on boolean types not implemented\n", __FILE__, __LINE__, expr->binary_op.op);
 				abort();
 		}
 	} else if (t->kind == AST_INTEGER_TYPE) {
+		int u = t->is_unsigned;
 		switch (expr->binary_op.op) {
 			case AST_ADD:
 				return LLVMBuildAdd(self->builder, lhs, rhs, "");
@@ -92,21 +184,21 @@ CODEGEN_EXPR(binary_expr) {
 			case AST_MUL:
 				return LLVMBuildMul(self->builder, lhs, rhs, "");
 			case AST_DIV:
-				return LLVMBuildSDiv(self->builder, lhs, rhs, "");
+				return u ? LLVMBuildUDiv(self->builder, lhs, rhs, "") : LLVMBuildSDiv(self->builder, lhs, rhs, "");
 			case AST_MOD:
-				return LLVMBuildSRem(self->builder, lhs, rhs, "");
+				return u ? LLVMBuildURem(self->builder, lhs, rhs, "") : LLVMBuildSRem(self->builder, lhs, rhs, "");
 			case AST_LEFT:
 				return LLVMBuildShl(self->builder, lhs, rhs, "");
 			case AST_RIGHT:
-				return LLVMBuildAShr(self->builder, lhs, rhs, "");
+				return u ? LLVMBuildLShr(self->builder, lhs, rhs, "") : LLVMBuildAShr(self->builder, lhs, rhs, "");
 			case AST_LT:
-				return LLVMBuildICmp(self->builder, LLVMIntSLT, lhs, rhs, "");
+				return LLVMBuildICmp(self->builder, u ? LLVMIntULT : LLVMIntSLT, lhs, rhs, "");
 			case AST_GT:
-				return LLVMBuildICmp(self->builder, LLVMIntSGT, lhs, rhs, "");
+				return LLVMBuildICmp(self->builder, u ? LLVMIntUGT : LLVMIntSGT, lhs, rhs, "");
 			case AST_LE:
-				return LLVMBuildICmp(self->builder, LLVMIntSLE, lhs, rhs, "");
+				return LLVMBuildICmp(self->builder, u ? LLVMIntULE : LLVMIntSLE, lhs, rhs, "");
 			case AST_GE:
-				return LLVMBuildICmp(self->builder, LLVMIntSGE, lhs, rhs, "");
+				return LLVMBuildICmp(self->builder, u ? LLVMIntUGE : LLVMIntSGE, lhs, rhs, "");
 			case AST_EQ:
 				return LLVMBuildICmp(self->builder, LLVMIntEQ, lhs, rhs, "");
 			case AST_NE:
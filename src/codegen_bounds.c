@@ -0,0 +1,428 @@
+#include "codegen_internal.h"
+
+/*
+ * Bounds check elimination for slice index accesses. A for loop of the form
+ *
+ *     for i = N; i < bound; ++i { ... }
+ *
+ * keeps N <= i < bound throughout its body, provided that the body modifies
+ * neither i nor the bound, which is a literal, a local variable, or the length
+ * of a local slice. Since slicing checks that a slice's length does not exceed
+ * its capacity, accesses s[i] within the body need no check if the bound is
+ * len(s). Accesses to any other local slice t that the body does not modify
+ * are checked once ahead of the loop instead, by verifying that the bound does
+ * not exceed cap(t) if the loop is entered at all. This is only done for
+ * accesses that every iteration performs, i.e. that are reached from the top
+ * of the body without a branch, in a loop that cannot be left early. The facts
+ * established by the enclosing loops are kept in the `bounds_facts` list of
+ * the codegen.
+ *
+ * Checks that remain are emitted such that the failing branch never returns,
+ * which allows LLVM to drop checks dominated by an identical one.
+ */
+
+
+static int
+is_ident(expr_t *expr, const char *name) {
+	return expr && name && expr->kind == AST_IDENT_EXPR && strcmp(expr->ident, name) == 0;
+}
+
+/*
+ * Describes which uses of the variables `a` and `b` are of interest while
+ * walking the AST. Taking the address of either variable always counts. If
+ * `address_only` is not set, any modification counts as well.
+ */
+typedef struct var_use {
+	const char *a;
+	const char *b;
+	int address_only;
+} var_use_t;
+
+static int
+is_var(expr_t *expr, const var_use_t *use) {
+	return is_ident(expr, use->a) || is_ident(expr, use->b);
+}
+
+static int stmt_uses(stmt_t *stmt, const var_use_t *use);
+
+/*
+ * Returns whether the expression uses the variables as described by `use`.
+ * Unknown expressions are assumed to do so.
+ */
+static int
+expr_uses(expr_t *expr, const var_use_t *use) {
+	if (!expr)
+		return 0;
+	#define MODIFIES(e) (!use->address_only && is_var(e, use))
+	#define RECURSE(e) if (expr_uses(e, use)) return 1;
+	unsigned i;
+	switch (expr->kind) {
+		case AST_IDENT_EXPR:
+		case AST_NUMBER_LITERAL_EXPR:
+		case AST_STRING_LITERAL_EXPR:
+		case AST_SIZEOF_EXPR:
+		case AST_LABEL_ADDR_EXPR:
+			return 0;
+		case AST_INDEX_ACCESS_EXPR:
+			RECURSE(expr->index_access.target);
+			RECURSE(expr->index_access.index);
+			return 0;
+		case AST_INDEX_SLICE_EXPR:
+			RECURSE(expr->index_slice.target);
+			RECURSE(expr->index_slice.start);
+			RECURSE(expr->index_slice.end);
+			return 0;
+		case AST_CALL_EXPR:
+			RECURSE(expr->call.target);
+			for (i = 0; i < expr->call.num_args; ++i)
+				RECURSE(expr->call.args + i);
+			return 0;
+		case AST_MEMBER_ACCESS_EXPR:
+			RECURSE(expr->member_access.target);
+			return 0;
+		case AST_INCDEC_EXPR:
+			if (MODIFIES(expr->incdec_op.target))
+				return 1;
+			RECURSE(expr->incdec_op.target);
+			return 0;
+		case AST_UNARY_EXPR:
+			if (expr->unary_op.op == AST_ADDRESS && is_var(expr->unary_op.target, use))
+				return 1;
+			RECURSE(expr->unary_op.target);
+			return 0;
+		case AST_CAST_EXPR:
+			RECURSE(expr->cast.target);
+			return 0;
+		case AST_BINARY_EXPR:
+			RECURSE(expr->binary_op.lhs);
+			RECURSE(expr->binary_op.rhs);
+			return 0;
+		case AST_CONDITIONAL_EXPR:
+			RECURSE(expr->conditional.condition);
+			RECURSE(expr->conditional.true_expr);
+			RECURSE(expr->conditional.false_expr);
+			return 0;
+		case AST_ASSIGNMENT_EXPR:
+			if (MODIFIES(expr->assignment.target))
+				return 1;
+			RECURSE(expr->assignment.target);
+			RECURSE(expr->assignment.expr);
+			return 0;
+		case AST_COMMA_EXPR:
+			for (i = 0; i < expr->comma.num_exprs; ++i)
+				RECURSE(expr->comma.exprs + i);
+			return 0;
+		case AST_NEW_BUILTIN:
+			RECURSE(expr->newe.expr);
+			RECURSE(expr->newe.opts.align);
+			RECURSE(expr->newe.opts.arena);
+			return 0;
+		case AST_FREE_BUILTIN:
+			RECURSE(expr->free.expr);
+			return 0;
+		case AST_MAKE_BUILTIN:
+			RECURSE(expr->make.expr);
+			RECURSE(expr->make.opts.align);
+			RECURSE(expr->make.opts.arena);
+			return 0;
+		case AST_LENCAP_BUILTIN:
+			RECURSE(expr->lencap.expr);
+			return 0;
+		case AST_DISPOSE_BUILTIN:
+			if (MODIFIES(expr->dispose.expr))
+				return 1;
+			RECURSE(expr->dispose.expr);
+			return 0;
+		case AST_APPEND_BUILTIN:
+			if (MODIFIES(expr->append.slice))
+				return 1;
+			RECURSE(expr->append.slice);
+			for (i = 0; i < expr->append.num_elems; ++i)
+				RECURSE(expr->append.elems + i);
+			return 0;
+		case AST_COPY_BUILTIN:
+			RECURSE(expr->copy.dst);
+			RECURSE(expr->copy.src);
+			return 0;
+		case AST_SHUFFLE_BUILTIN:
+			for (i = 0; i < expr->shuffle.num_args; ++i)
+				RECURSE(expr->shuffle.args + i);
+			return 0;
+		case AST_REDUCE_BUILTIN:
+			RECURSE(expr->reduce.expr);
+			return 0;
+		case AST_ATOMIC_BUILTIN:
+			for (i = 0; i < expr->atomic.num_args; ++i)
+				RECURSE(expr->atomic.args + i);
+			return 0;
+		default:
+			return 1;
+	}
+	#undef RECURSE
+	#undef MODIFIES
+}
+
+/*
+ * Returns whether the statement uses the variables as described by `use`.
+ * Unknown statements are assumed to do so.
+ */
+static int
+stmt_uses(stmt_t *stmt, const var_use_t *use) {
+	if (!stmt)
+		return 0;
+	unsigned i;
+	switch (stmt->kind) {
+		case AST_EXPR_STMT:
+		case AST_RETURN_STMT:
+		case AST_INDIRECT_GOTO_STMT:
+			return expr_uses(stmt->expr, use);
+		case AST_COMPOUND_STMT:
+			for (i = 0; i < stmt->compound.num_items; ++i) {
+				block_item_t *item = stmt->compound.items + i;
+				if (item->kind == AST_STMT_BLOCK_ITEM && stmt_uses(item->stmt, use))
+					return 1;
+				if (item->kind == AST_DECL_BLOCK_ITEM && item->decl->kind == AST_VARIABLE_DECL &&
+				    expr_uses(item->decl->variable.initial, use))
+					return 1;
+			}
+			return 0;
+		case AST_IF_STMT:
+		case AST_SWITCH_STMT:
+			return expr_uses(stmt->selection.condition, use) ||
+				stmt_uses(stmt->selection.stmt, use) ||
+				stmt_uses(stmt->selection.else_stmt, use);
+		case AST_DO_STMT:
+		case AST_FOR_STMT:
+			return expr_uses(stmt->iteration.initial, use) ||
+				expr_uses(stmt->iteration.condition, use) ||
+				expr_uses(stmt->iteration.step, use) ||
+				stmt_uses(stmt->iteration.stmt, use);
+		case AST_CONTINUE_STMT:
+		case AST_BREAK_STMT:
+			return 0;
+		case AST_GOTO_STMT:
+		case AST_LABEL_STMT:
+			// A jump into the loop body bypasses the loop condition.
+			return 1;
+		case AST_DEFAULT_STMT:
+			return stmt_uses(stmt->label.stmt, use);
+		case AST_CASE_STMT:
+			return expr_uses(stmt->label.expr, use) || stmt_uses(stmt->label.stmt, use);
+		case AST_UNCHECKED_STMT:
+			return stmt_uses(stmt->body, use);
+		default:
+			return 1;
+	}
+}
+
+/*
+ * Returns whether the statement may leave the enclosing loop before the
+ * iteration completes, through a break, a return, or a jump. Breaks within
+ * nested loops and switch statements do not count.
+ */
+static int
+stmt_leaves_loop(stmt_t *stmt, int nested) {
+	if (!stmt)
+		return 0;
+	unsigned i;
+	switch (stmt->kind) {
+		case AST_EXPR_STMT:
+		case AST_CONTINUE_STMT:
+			return 0;
+		case AST_BREAK_STMT:
+			return !nested;
+		case AST_COMPOUND_STMT:
+			for (i = 0; i < stmt->compound.num_items; ++i) {
+				block_item_t *item = stmt->compound.items + i;
+				if (item->kind == AST_STMT_BLOCK_ITEM && stmt_leaves_loop(item->stmt, nested))
+					return 1;
+			}
+			return 0;
+		case AST_IF_STMT:
+			return stmt_leaves_loop(stmt->selection.stmt, nested) ||
+				stmt_leaves_loop(stmt->selection.else_stmt, nested);
+		case AST_SWITCH_STMT:
+			return stmt_leaves_loop(stmt->selection.stmt, 1);
+		case AST_DO_STMT:
+		case AST_FOR_STMT:
+			return stmt_leaves_loop(stmt->iteration.stmt, 1);
+		case AST_DEFAULT_STMT:
+		case AST_CASE_STMT:
+			return stmt_leaves_loop(stmt->label.stmt, nested);
+		case AST_UNCHECKED_STMT:
+			return stmt_leaves_loop(stmt->body, nested);
+		default:
+			return 1;
+	}
+}
+
+/*
+ * Returns the local variable an identifier refers to, or null if the
+ * identifier does not name a local variable.
+ */
+static LLVMValueRef
+local_variable(codegen_context_t *context, expr_t *expr) {
+	if (!expr || expr->kind != AST_IDENT_EXPR)
+		return 0;
+	codegen_symbol_t *sym = codegen_context_find_symbol(context, expr->ident);
+	if (!sym || sym->kind == FUNC_SYMBOL || !sym->value || !LLVMIsAAllocaInst(sym->value))
+		return 0;
+	return sym->value;
+}
+
+static int
+is_increment(expr_t *expr, const char *name) {
+	if (!expr)
+		return 0;
+	if (expr->kind == AST_INCDEC_EXPR)
+		return expr->incdec_op.direction == AST_INC && is_ident(expr->incdec_op.target, name);
+	if (expr->kind == AST_ASSIGNMENT_EXPR) {
+		expr_t *rhs = expr->assignment.expr;
+		return expr->assignment.op == AST_ADD_ASSIGN &&
+			is_ident(expr->assignment.target, name) &&
+			rhs->kind == AST_NUMBER_LITERAL_EXPR && strcmp(rhs->number_literal.literal, "1") == 0;
+	}
+	return 0;
+}
+
+/*
+ * Returns whether the variables `a` and `b` are modified by the body of a loop
+ * or have their address taken anywhere in the current function.
+ */
+static int
+loop_modifies(codegen_t *self, stmt_t *loop, const char *a, const char *b) {
+	var_use_t modified = { a, b, 0 };
+	if (stmt_uses(loop->iteration.stmt, &modified))
+		return 1;
+	var_use_t escaped = { a, b, 1 };
+	return !self->unit || self->unit->kind != AST_FUNC_UNIT || stmt_uses(self->unit->func.body, &escaped);
+}
+
+/*
+ * Checks whether a for loop has the form `for i = N; i < bound; ++i`, where N
+ * is a non-negative literal, i is a 64 bit local integer, and the bound is a
+ * literal, a local variable, or `len(s)` of a local slice s, none of which are
+ * modified by the loop body. If so, fills in the fact that i stays within the
+ * bound throughout the body and returns 1.
+ */
+int
+codegen_bounds_loop_fact(codegen_t *self, codegen_context_t *context, stmt_t *stmt, bounds_fact_t *fact) {
+	assert(stmt && stmt->kind == AST_FOR_STMT);
+	expr_t *init = stmt->iteration.initial;
+	expr_t *cond = stmt->iteration.condition;
+	if (!init || !cond || !stmt->iteration.step)
+		return 0;
+
+	// i < bound
+	if (cond->kind != AST_BINARY_EXPR || cond->binary_op.op != AST_LT)
+		return 0;
+	expr_t *index = cond->binary_op.lhs;
+	expr_t *bound = cond->binary_op.rhs;
+	if (index->kind != AST_IDENT_EXPR)
+		return 0;
+	if (index->type.kind != AST_INTEGER_TYPE || index->type.pointer > 0 || index->type.width != 64)
+		return 0;
+
+	// i = N
+	expr_t *start = init->kind == AST_ASSIGNMENT_EXPR ? init->assignment.expr : 0;
+	if (init->kind != AST_ASSIGNMENT_EXPR || init->assignment.op != AST_ASSIGN ||
+	    !is_ident(init->assignment.target, index->ident) ||
+	    start->kind != AST_NUMBER_LITERAL_EXPR || !start->constant.known || start->constant.i < 0)
+		return 0;
+
+	// ++i, i++, or i += 1
+	if (!is_increment(stmt->iteration.step, index->ident))
+		return 0;
+
+	bzero(fact, sizeof(*fact));
+	fact->index = local_variable(context, index);
+	if (!fact->index)
+		return 0;
+
+	const char *invariant = 0;
+	if (bound->kind == AST_LENCAP_BUILTIN && bound->lencap.kind == AST_LEN) {
+		fact->slice = local_variable(context, bound->lencap.expr);
+		if (!fact->slice)
+			return 0;
+		invariant = bound->lencap.expr->ident;
+	} else if (bound->kind == AST_IDENT_EXPR) {
+		if (!local_variable(context, bound))
+			return 0;
+		invariant = bound->ident;
+	} else if (bound->kind != AST_NUMBER_LITERAL_EXPR) {
+		return 0;
+	}
+
+	// Neither variable may be modified by the body, nor through a pointer
+	// obtained anywhere in the function.
+	if (loop_modifies(self, stmt, index->ident, invariant))
+		return 0;
+
+	fact->loop = stmt;
+	fact->context = context;
+	fact->bound = bound;
+	fact->start = start->constant.i;
+	fact->leaves = stmt_leaves_loop(stmt->iteration.stmt, 0);
+	array_init(&fact->checked, sizeof(LLVMValueRef));
+	return 1;
+}
+
+/*
+ * Emits a check in the guard block of a loop that indexing into `target` with
+ * any value in [start,bound) is within bounds, unless the loop is not entered
+ * at all. Returns whether the check could be hoisted.
+ */
+static int
+hoist_check(codegen_t *self, bounds_fact_t *fact, expr_t *target, LLVMValueRef tv) {
+	unsigned i;
+	for (i = 0; i < fact->checked.size; ++i)
+		if (*(LLVMValueRef*)array_get(&fact->checked, i) == tv)
+			return 1;
+
+	// The access must happen in every iteration, since otherwise a valid
+	// program could fail the hoisted check.
+	if (fact->leaves || LLVMGetInsertBlock(self->builder) != fact->straight)
+		return 0;
+
+	// The slice must be declared outside of the loop and not change within.
+	if (local_variable(fact->context, target) != tv || loop_modifies(self, fact->loop, target->ident, 0))
+		return 0;
+
+	LLVMBasicBlockRef block = LLVMGetInsertBlock(self->builder);
+	LLVMPositionBuilderAtEnd(self->builder, fact->guard);
+	LLVMValueRef slice = codegen_expr(self, fact->context, target, 0, 0);
+	LLVMValueRef cap = LLVMBuildExtractValue(self->builder, slice, 2, "cap");
+	LLVMValueRef bound = codegen_expr(self, fact->context, fact->bound, 0, 0);
+	LLVMValueRef start = LLVMConstInt(LLVMTypeOf(bound), fact->start, 0);
+	int is_unsigned = fact->bound->type.is_unsigned;
+	LLVMValueRef skipped = LLVMBuildICmp(self->builder, is_unsigned ? LLVMIntULE : LLVMIntSLE, bound, start, "");
+	LLVMValueRef fits = LLVMBuildICmp(self->builder, LLVMIntULE, bound, cap, "");
+	codegen_check(self, LLVMBuildOr(self->builder, skipped, fits, ""), &target->loc, bound);
+	fact->guard = LLVMGetInsertBlock(self->builder);
+	LLVMPositionBuilderAtEnd(self->builder, block);
+
+	array_add(&fact->checked, &tv);
+	return 1;
+}
+
+/*
+ * Returns whether indexing into `target` with `index` is known to be within
+ * bounds due to an enclosing loop, possibly by a check hoisted out of it.
+ */
+int
+codegen_bounds_known(codegen_t *self, codegen_context_t *context, expr_t *target, expr_t *index) {
+	if (!self->bounds_facts)
+		return 0;
+	LLVMValueRef tv = local_variable(context, target);
+	LLVMValueRef iv = local_variable(context, index);
+	if (!tv || !iv)
+		return 0;
+	bounds_fact_t *fact;
+	for (fact = self->bounds_facts; fact; fact = fact->prev) {
+		if (fact->index != iv)
+			continue;
+		if (fact->slice == tv || hoist_check(self, fact, target, tv))
+			return 1;
+	}
+	return 0;
+}
@@ -1,46 +1,260 @@
 /* Copyright (c) 2015-2016 Fabian Schuiki, Thomas Richner */
 #include "codegen_internal.h"
+#include "options.h"
 
 
 /*
- * generates IR to allocate zero initialised array on heap, return pointer to new array
- * similar to `calloc(type,size)`
+ * Returns the function called `name` in the current module, declaring it with
+ * the given type if it does not exist yet. The result is cast to the requested
+ * function type such that it may be called even if a user-supplied function of
+ * that name has a slightly different signature.
  */
 static LLVMValueRef
-codegen_array_new(codegen_t* self, codegen_context_t *context,LLVMTypeRef type,LLVMValueRef size){
-	//---- malloc on heap
-	LLVMValueRef arrptr = LLVMBuildArrayMalloc(self->builder,type,size,"");
+get_runtime_func(codegen_t *self, const char *name, LLVMTypeRef type){
+	LLVMValueRef fn = LLVMGetNamedFunction(self->module, name);
+	if (!fn)
+		return LLVMAddFunction(self->module, name, type);
+	return LLVMConstPointerCast(fn, LLVMPointerType(type, 0));
+}
 
-	//TODO check for nonzero
+/* Returns the alignment of a type in bytes as an i64 constant. */
+static LLVMValueRef
+codegen_align_of(codegen_context_t *context, type_t *type) {
+	unsigned align = codegen_type_align(context, type);
+	if (align)
+		return LLVMConstInt(LLVMInt64Type(), align, 0);
+	return LLVMAlignOf(codegen_type(context, type));
+}
 
-	//---- zero initialise TODO: use memset intrinsic
-	LLVMValueRef cntrptr = LLVMBuildAlloca(self->builder,LLVMTypeOf(size),"cntrptr");
-	LLVMBuildStore(self->builder,size,cntrptr);
+/*
+ * Generates IR to allocate memory for `count` elements of `type` on the heap
+ * and returns a pointer to the first element. If `count` is null, a single
+ * element is allocated. Unless the options request otherwise, the memory is
+ * zero initialised, similar to `calloc(count,sizeof(type))`.
+ *
+ * If an arena was specified, the memory is obtained from `arena_alloc` (see
+ * lib/arena.low). Otherwise, if an allocation function was specified on the
+ * command line, it is called with the size and alignment of the memory.
+ * Otherwise the memory is obtained through `aligned_alloc` if an alignment was
+ * requested or the type requires one, or through a plain `malloc`. Requested
+ * alignments must be a power of two, which is checked if they are constant.
+ */
+static LLVMValueRef
+codegen_alloc(codegen_t *self, codegen_context_t *context, type_t *elem_type, LLVMValueRef count, alloc_opts_t *opts){
+	LLVMTypeRef int64 = LLVMInt64Type();
+	LLVMTypeRef int8ptr = LLVMPointerType(LLVMInt8Type(), 0);
+	LLVMTypeRef type = codegen_type(context, elem_type);
+
+	//---- size of the allocation in bytes
+	LLVMValueRef size = LLVMSizeOf(type);
+	if (count) {
+		count = LLVMBuildIntCast(self->builder, count, int64, "");
+		size = LLVMBuildMul(self->builder, size, count, "size");
+	}
 
-	LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(self->builder));
-	LLVMBasicBlockRef loop_block = LLVMAppendBasicBlock(func, "loopcond");
-	LLVMBasicBlockRef body_block = LLVMAppendBasicBlock(func, "loopbody");
-	LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(func, "loopexit");
-	LLVMBuildBr(self->builder, loop_block);
-
-	// Check the loop condition.
-	LLVMPositionBuilderAtEnd(self->builder, loop_block);
-	LLVMValueRef cntr = LLVMBuildLoad(self->builder,cntrptr,"cntr");
-	LLVMValueRef cond = LLVMBuildICmp(self->builder,LLVMIntSLE,LLVMConstNull(LLVMTypeOf(cntr)),cntr,"cond");
-	LLVMBuildCondBr(self->builder, cond, body_block, exit_block);
-
-	// Execute the loop body.
-	LLVMPositionBuilderAtEnd(self->builder, body_block);
-	//LLVMValueRef iptr  = LLVMBuildInBoundsGEP(self->builder, arrptr, (LLVMValueRef[]){LLVMConstNull(LLVMInt32Type()), cntrptr}, 2, "");
-	LLVMValueRef iptr  = LLVMBuildInBoundsGEP(self->builder, arrptr, (LLVMValueRef[]){cntr}, 1, "");
-	LLVMBuildStore(self->builder,LLVMConstNull(type),iptr);
-	cntr = LLVMBuildSub(self->builder,cntr,LLVMConstInt(LLVMTypeOf(cntr),1,0),"");
-	LLVMBuildStore(self->builder,cntr,cntrptr);
-	LLVMBuildBr(self->builder, loop_block);
+	LLVMValueRef align = 0;
+	if (opts && opts->align) {
+		align = codegen_expr(self, context, opts->align, 0, 0);
+		align = LLVMBuildIntCast(self->builder, align, int64, "align");
+		if (LLVMIsAConstantInt(align)) {
+			unsigned long long value = LLVMConstIntGetZExtValue(align);
+			if (value == 0 || (value & (value - 1)) != 0)
+				derror(&opts->align->loc, "alignment must be a power of two\n");
+		}
+	} else if (codegen_type_align(context, elem_type)) {
+		align = codegen_align_of(context, elem_type);
+	}
+
+	LLVMValueRef ptr;
+	if (opts && opts->arena) {
+		//---- arena allocation
+		codegen_symbol_t *sym = codegen_context_find_symbol(context, "arena_alloc");
+		assert(sym && sym->kind == FUNC_SYMBOL);
+		if (!align)
+			align = codegen_align_of(context, elem_type);
+		LLVMValueRef arena = codegen_expr(self, context, opts->arena, 0, 0);
+		ptr = LLVMBuildCall(self->builder, sym->value, (LLVMValueRef[]){arena, size, align}, 3, "");
+		ptr = LLVMBuildPointerCast(self->builder, ptr, LLVMPointerType(type, 0), "");
+	} else if (options.alloc_func) {
+		//---- user-supplied allocator
+		if (!align)
+			align = codegen_align_of(context, elem_type);
+		LLVMTypeRef args[2] = { int64, int64 };
+		LLVMValueRef fn = get_runtime_func(self, options.alloc_func, LLVMFunctionType(int8ptr, args, 2, 0));
+		ptr = LLVMBuildCall(self->builder, fn, (LLVMValueRef[]){size, align}, 2, "");
+		ptr = LLVMBuildPointerCast(self->builder, ptr, LLVMPointerType(type, 0), "");
+	} else if (align) {
+		//---- aligned_alloc requires the size to be a multiple of the alignment
+		LLVMValueRef mask = LLVMBuildSub(self->builder, align, LLVMConstInt(int64, 1, 0), "");
+		size = LLVMBuildAdd(self->builder, size, mask, "");
+		size = LLVMBuildAnd(self->builder, size, LLVMBuildNot(self->builder, mask, ""), "size");
+
+		LLVMTypeRef args[2] = { int64, int64 };
+		LLVMValueRef fn = get_runtime_func(self, "aligned_alloc", LLVMFunctionType(int8ptr, args, 2, 0));
+		ptr = LLVMBuildCall(self->builder, fn, (LLVMValueRef[]){align, size}, 2, "");
+		ptr = LLVMBuildPointerCast(self->builder, ptr, LLVMPointerType(type, 0), "");
+	} else if (count) {
+		ptr = LLVMBuildArrayMalloc(self->builder, type, count, "");
+	} else {
+		ptr = LLVMBuildMalloc(self->builder, type, "");
+	}
+
+	//---- zero initialise
+	if (!opts || !opts->noinit)
+		LLVMBuildMemSet(self->builder, ptr, LLVMConstNull(LLVMInt8Type()), size, 1);
+
+	return ptr;
+}
+
+/*
+ * Generates IR to release memory obtained through codegen_alloc. Calls the
+ * release function specified on the command line, or `free` otherwise.
+ */
+static LLVMValueRef
+codegen_release(codegen_t *self, LLVMValueRef ptr){
+	if (!options.free_func)
+		return LLVMBuildFree(self->builder, ptr);
+
+	LLVMTypeRef int8ptr = LLVMPointerType(LLVMInt8Type(), 0);
+	LLVMValueRef fn = get_runtime_func(self, options.free_func, LLVMFunctionType(LLVMVoidType(), &int8ptr, 1, 0));
+	ptr = LLVMBuildPointerCast(self->builder, ptr, int8ptr, "");
+	return LLVMBuildCall(self->builder, fn, &ptr, 1, "");
+}
+
+/*
+ * Returns the function that grows slices for the append() builtin, generating
+ * it on first use. It operates on an untyped slice `{i8*, i64, i64, i8*, i1}`,
+ * whose layout matches that of every slice type:
+ *
+ *     i8* low.slice_grow(slice*, i64 need, i64 elemsize, i64 align, i8* src)
+ *
+ * The capacity is at least doubled and at least `need`. Slices created by
+ * make(), and subslices of them starting at the first element, own their
+ * memory, which is resized with `realloc`. Slices of arrays, other subslices,
+ * and slices of arena memory have their elements copied into a new allocation
+ * instead, and the original memory is left to its owner. Either way the slice owns its memory afterwards. Since
+ * `src` may point into the memory being resized, it is returned relocated to
+ * the new memory if necessary.
+ */
+static LLVMValueRef
+get_slice_grow_func(codegen_t *self){
+	static const char *name = "low.slice_grow";
+	LLVMValueRef fn = LLVMGetNamedFunction(self->module, name);
+	if (fn)
+		return fn;
+
+	LLVMTypeRef int64 = LLVMInt64Type();
+	LLVMTypeRef int8ptr = LLVMPointerType(LLVMInt8Type(), 0);
+	LLVMTypeRef slice_type = LLVMStructType((LLVMTypeRef[]){int8ptr, int64, int64, int8ptr, LLVMInt1Type()}, 5, 0);
+	LLVMTypeRef args[5] = { LLVMPointerType(slice_type, 0), int64, int64, int64, int8ptr };
+	fn = LLVMAddFunction(self->module, name, LLVMFunctionType(int8ptr, args, 5, 0));
+	LLVMSetLinkage(fn, LLVMInternalLinkage);
+
+	// Growing is the rare case, so keep it out of the callers' hot paths.
+	LLVMContextRef ctx = LLVMGetModuleContext(self->module);
+	const char *attrs[] = { "noinline", "cold" };
+	unsigned i;
+	for (i = 0; i < 2; ++i) {
+		unsigned kind = LLVMGetEnumAttributeKindForName(attrs[i], strlen(attrs[i]));
+		LLVMAddAttributeAtIndex(fn, LLVMAttributeFunctionIndex, LLVMCreateEnumAttribute(ctx, kind, 0));
+	}
 
+	LLVMValueRef slice = LLVMGetParam(fn, 0);
+	LLVMValueRef need = LLVMGetParam(fn, 1);
+	LLVMValueRef elemsize = LLVMGetParam(fn, 2);
+	LLVMValueRef align = LLVMGetParam(fn, 3);
+	LLVMValueRef src = LLVMGetParam(fn, 4);
+
+	LLVMBasicBlockRef prev_block = LLVMGetInsertBlock(self->builder);
+	LLVMBasicBlockRef entry_block = LLVMAppendBasicBlock(fn, "entry");
+	LLVMBasicBlockRef resize_block = LLVMAppendBasicBlock(fn, "resize");
+	LLVMBasicBlockRef copy_block = LLVMAppendBasicBlock(fn, "copy");
+	LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(fn, "exit");
+
+	//---- compute the new capacity
+	LLVMPositionBuilderAtEnd(self->builder, entry_block);
+	LLVMValueRef ptr = LLVMBuildLoad(self->builder, LLVMBuildStructGEP(self->builder, slice, 0, ""), "arrptr");
+	LLVMValueRef len = LLVMBuildLoad(self->builder, LLVMBuildStructGEP(self->builder, slice, 1, ""), "len");
+	LLVMValueRef cap = LLVMBuildLoad(self->builder, LLVMBuildStructGEP(self->builder, slice, 2, ""), "cap");
+	LLVMValueRef base = LLVMBuildLoad(self->builder, LLVMBuildStructGEP(self->builder, slice, 3, ""), "baseptr");
+	LLVMValueRef owned = LLVMBuildLoad(self->builder, LLVMBuildStructGEP(self->builder, slice, 4, ""), "owned");
+
+	LLVMValueRef newcap = LLVMBuildMul(self->builder, cap, LLVMConstInt(int64, 2, 0), "");
+	LLVMValueRef too_small = LLVMBuildICmp(self->builder, LLVMIntULT, newcap, need, "");
+	newcap = LLVMBuildSelect(self->builder, too_small, need, newcap, "newcap");
+	LLVMValueRef size = LLVMBuildMul(self->builder, newcap, elemsize, "size");
+	LLVMValueRef used = LLVMBuildMul(self->builder, len, elemsize, "used");
+	LLVMValueRef capsize = LLVMBuildMul(self->builder, cap, elemsize, "");
+	LLVMBuildCondBr(self->builder, owned, resize_block, copy_block);
+
+	//---- resize the memory owned by the slice
+	LLVMPositionBuilderAtEnd(self->builder, resize_block);
+	LLVMValueRef resized;
+	if (options.alloc_func) {
+		LLVMValueRef alloc = get_runtime_func(self, options.alloc_func, LLVMFunctionType(int8ptr, (LLVMTypeRef[]){int64, int64}, 2, 0));
+		resized = LLVMBuildCall(self->builder, alloc, (LLVMValueRef[]){size, align}, 2, "");
+		LLVMBuildMemCpy(self->builder, resized, 1, base, 1, capsize);
+		codegen_release(self, base);
+	} else {
+		LLVMValueRef realloc = get_runtime_func(self, "realloc", LLVMFunctionType(int8ptr, (LLVMTypeRef[]){int8ptr, int64}, 2, 0));
+		resized = LLVMBuildCall(self->builder, realloc, (LLVMValueRef[]){base, size}, 2, "");
+	}
+	LLVMValueRef src_offset = LLVMBuildSub(self->builder,
+		LLVMBuildPtrToInt(self->builder, src, int64, ""),
+		LLVMBuildPtrToInt(self->builder, base, int64, ""), "");
+	LLVMValueRef src_inside = LLVMBuildICmp(self->builder, LLVMIntULT, src_offset, capsize, "");
+	LLVMValueRef src_moved = LLVMBuildInBoundsGEP(self->builder, resized, &src_offset, 1, "");
+	src_moved = LLVMBuildSelect(self->builder, src_inside, src_moved, src, "");
+	LLVMBuildBr(self->builder, exit_block);
+
+	//---- copy the elements out of memory owned by someone else
+	LLVMPositionBuilderAtEnd(self->builder, copy_block);
+	LLVMValueRef copied;
+	if (options.alloc_func) {
+		LLVMValueRef alloc = get_runtime_func(self, options.alloc_func, LLVMFunctionType(int8ptr, (LLVMTypeRef[]){int64, int64}, 2, 0));
+		copied = LLVMBuildCall(self->builder, alloc, (LLVMValueRef[]){size, align}, 2, "");
+	} else {
+		copied = LLVMBuildArrayMalloc(self->builder, LLVMInt8Type(), size, "");
+	}
+	LLVMBuildMemCpy(self->builder, copied, 1, ptr, 1, used);
+	LLVMBuildBr(self->builder, exit_block);
+
+	//---- update the slice
 	LLVMPositionBuilderAtEnd(self->builder, exit_block);
+	LLVMValueRef newptr = LLVMBuildPhi(self->builder, int8ptr, "");
+	LLVMAddIncoming(newptr, (LLVMValueRef[]){resized, copied}, (LLVMBasicBlockRef[]){resize_block, copy_block}, 2);
+	LLVMValueRef newsrc = LLVMBuildPhi(self->builder, int8ptr, "");
+	LLVMAddIncoming(newsrc, (LLVMValueRef[]){src_moved, src}, (LLVMBasicBlockRef[]){resize_block, copy_block}, 2);
+	LLVMBuildStore(self->builder, newptr, LLVMBuildStructGEP(self->builder, slice, 0, ""));
+	LLVMBuildStore(self->builder, newcap, LLVMBuildStructGEP(self->builder, slice, 2, ""));
+	LLVMBuildStore(self->builder, newptr, LLVMBuildStructGEP(self->builder, slice, 3, ""));
+	LLVMBuildStore(self->builder, LLVMConstInt(LLVMInt1Type(), 1, 0), LLVMBuildStructGEP(self->builder, slice, 4, ""));
+	LLVMBuildRet(self->builder, newsrc);
+
+	if (prev_block)
+		LLVMPositionBuilderAtEnd(self->builder, prev_block);
+	return fn;
+}
 
-	return arrptr;
+static void
+prepare_alloc_opts(codegen_t *self, codegen_context_t *context, alloc_opts_t *opts) {
+	if (opts->align) {
+		type_t int_type = { .kind = AST_INTEGER_TYPE, .width = 64 };
+		prepare_expr(self, context, opts->align, &int_type);
+		if (opts->align->type.kind != AST_INTEGER_TYPE || opts->align->type.pointer > 0)
+			derror(&opts->align->loc, "alignment needs to be an integer\n");
+	}
+	if (opts->arena) {
+		prepare_expr(self, context, opts->arena, 0);
+		codegen_symbol_t *sym = codegen_context_find_symbol(context, "arena_alloc");
+		if (!sym || sym->kind != FUNC_SYMBOL)
+			derror(&opts->arena->loc, "allocating in an arena requires arena_alloc, import lib/arena.low\n");
+		if (sym->type->func.num_args != 3 || !type_equal(&opts->arena->type, sym->type->func.args)) {
+			char *td = type_describe(&opts->arena->type);
+			derror(&opts->arena->loc, "cannot allocate in %s, expected a pointer to an arena\n", td);
+			free(td);
+		}
+	}
 }
 
 
@@ -50,6 +264,7 @@ PREPARE_EXPR(new_builtin_expr) {
 		type_t int_type = {.kind=AST_INTEGER_TYPE,.width=64};
 		prepare_expr(self, context, expr->newe.expr, &int_type);
 	}
+	prepare_alloc_opts(self, context, &expr->newe.opts);
 	type_copy(&expr->type, &expr->newe.type);
 	++expr->type.pointer;
 }
@@ -70,6 +285,7 @@ PREPARE_EXPR(make_builtin_expr) {
 	}
 	type_t int_type = { .kind = AST_INTEGER_TYPE, .width = 64 };
 	prepare_expr(self, context, expr->make.expr, &int_type);
+	prepare_alloc_opts(self, context, &expr->make.opts);
 	type_copy(&expr->type, &expr->make.type);
 }
 
@@ -97,24 +313,70 @@ PREPARE_EXPR(dispose_builtin_expr) {
 	}
 }
 
-CODEGEN_EXPR(new_builtin_expr) {
-	LLVMTypeRef type = codegen_type(context, &expr->newe.type);
+PREPARE_EXPR(append_builtin_expr) {
+	prepare_expr(self, context, expr->append.slice, type_hint);
+	type_t *type = resolve_type_name(context, &expr->append.slice->type);
+	if (type->kind != AST_SLICE_TYPE || type->pointer > 0) {
+		char *td = type_describe(&expr->append.slice->type);
+		derror(&expr->loc, "cannot append to %s, expected a slice\n", td);
+		free(td);
+	}
 
-	LLVMValueRef ptr;
+	unsigned i;
+	for (i = 0; i < expr->append.num_elems; ++i) {
+		expr_t *elem = expr->append.elems + i;
+		type_t *elem_type;
+		if (expr->append.spread) {
+			prepare_expr(self, context, elem, &expr->append.slice->type);
+			type_t *src = resolve_type_name(context, &elem->type);
+			elem_type = (src->kind == AST_SLICE_TYPE && src->pointer == 0) ? src->slice.type : 0;
+		} else {
+			prepare_expr(self, context, elem, type->slice.type);
+			elem_type = &elem->type;
+		}
+		if (!elem_type || !type_equal(elem_type, type->slice.type)) {
+			char *t1 = type_describe(&elem->type);
+			char *t2 = type_describe(&expr->append.slice->type);
+			derror(&elem->loc, "cannot append %s%s to %s\n", t1, expr->append.spread ? "..." : "", t2);
+			free(t1);
+			free(t2);
+		}
+	}
+
+	type_copy(&expr->type, &expr->append.slice->type);
+}
+
+PREPARE_EXPR(copy_builtin_expr) {
+	prepare_expr(self, context, expr->copy.dst, 0);
+	prepare_expr(self, context, expr->copy.src, &expr->copy.dst->type);
+	type_t *dst = resolve_type_name(context, &expr->copy.dst->type);
+	type_t *src = resolve_type_name(context, &expr->copy.src->type);
+	if (dst->kind != AST_SLICE_TYPE || dst->pointer > 0 ||
+	    src->kind != AST_SLICE_TYPE || src->pointer > 0 ||
+	    !type_equal(dst->slice.type, src->slice.type)) {
+		char *t1 = type_describe(&expr->copy.dst->type);
+		char *t2 = type_describe(&expr->copy.src->type);
+		derror(&expr->loc, "cannot copy %s to %s, expected slices of the same type\n", t2, t1);
+		free(t1);
+		free(t2);
+	}
+
+	type_t int_type = { .kind = AST_INTEGER_TYPE, .width = 64 };
+	type_copy(&expr->type, &int_type);
+}
+
+CODEGEN_EXPR(new_builtin_expr) {
+	LLVMValueRef size = 0;
 	if(expr->newe.expr){
-		LLVMValueRef size = codegen_expr(self, context, expr->newe.expr, 0, 0);
-		ptr = codegen_array_new(self,context,type,size);
-	}else{
-		ptr = LLVMBuildMalloc(self->builder,type,"");
-		LLVMBuildStore(self->builder,LLVMConstNull(type),ptr);
+		size = codegen_expr(self, context, expr->newe.expr, 0, 0);
 	}
 
-	return ptr;
+	return codegen_alloc(self, context, &expr->newe.type, size, &expr->newe.opts);
 }
 
 CODEGEN_EXPR(free_builtin_expr) {
 	LLVMValueRef ptr = codegen_expr(self, context, expr->free.expr, 0, 0);
-	return LLVMBuildFree(self->builder,ptr);
+	return codegen_release(self, ptr);
 }
 
 CODEGEN_EXPR(make_builtin_expr) {
@@ -130,7 +392,7 @@ CODEGEN_EXPR(make_builtin_expr) {
 
 	//---- alloc array on heap
 	LLVMTypeRef element_type = codegen_type(context, type->slice.type); // array element type
-	LLVMValueRef arrptr = codegen_array_new(self,context,element_type,caparg);
+	LLVMValueRef arrptr = codegen_alloc(self, context, type->slice.type, caparg, &expr->make.opts);
 	LLVMTypeRef array_type = LLVMPointerType(element_type, 0);
 	arrptr = LLVMBuildPointerCast(self->builder,arrptr,array_type,"");
 
@@ -142,6 +404,10 @@ CODEGEN_EXPR(make_builtin_expr) {
 	slice = LLVMBuildInsertValue(self->builder, slice, caparg, 2, "cap");
 	slice = LLVMBuildInsertValue(self->builder, slice, arrptr, 3, "baseptr");
 
+	//---- memory from an arena cannot be resized by append()
+	if (!expr->make.opts.arena)
+		slice = LLVMBuildInsertValue(self->builder, slice, LLVMConstInt(LLVMInt1Type(), 1, 0), 4, "owned");
+
 	return slice;
 }
 
@@ -167,5 +433,104 @@ CODEGEN_EXPR(dispose_builtin_expr) {
 	// set slice to zero
 	LLVMBuildStore(self->builder, LLVMConstNull(LLVMTypeOf(slice)), slice_ptr);
 
-	return LLVMBuildFree(self->builder, ptr);
+	return codegen_release(self, ptr);
+}
+
+/*
+ * Appends elements to a slice in place. If the slice has enough capacity, the
+ * elements are simply stored behind its last element. Otherwise the slice is
+ * first grown by the out-of-line function returned by get_slice_grow_func.
+ */
+CODEGEN_EXPR(append_builtin_expr) {
+	type_t *type = resolve_type_name(context, &expr->append.slice->type);
+	LLVMTypeRef element_type = codegen_type(context, type->slice.type);
+	LLVMTypeRef int64 = LLVMInt64Type();
+	LLVMTypeRef int8ptr = LLVMPointerType(LLVMInt8Type(), 0);
+
+	LLVMValueRef slice_ptr = codegen_expr(self, context, expr->append.slice, 1, 0);
+
+	//---- evaluate the elements before the slice is modified
+	unsigned i, num_values = expr->append.spread ? 0 : expr->append.num_elems;
+	LLVMValueRef values[num_values+1];
+	LLVMValueRef src = 0, count;
+	if (expr->append.spread) {
+		LLVMValueRef src_slice = codegen_expr(self, context, expr->append.elems, 0, 0);
+		src = LLVMBuildExtractValue(self->builder, src_slice, 0, "");
+		count = LLVMBuildExtractValue(self->builder, src_slice, 1, "");
+	} else {
+		for (i = 0; i < num_values; ++i)
+			values[i] = codegen_expr(self, context, expr->append.elems + i, 0, 0);
+		count = LLVMConstInt(int64, num_values, 0);
+	}
+
+	//---- grow the slice if it lacks capacity
+	LLVMValueRef slice = LLVMBuildLoad(self->builder, slice_ptr, "");
+	LLVMValueRef len = LLVMBuildExtractValue(self->builder, slice, 1, "len");
+	LLVMValueRef cap = LLVMBuildExtractValue(self->builder, slice, 2, "cap");
+	LLVMValueRef need = LLVMBuildAdd(self->builder, len, count, "need");
+
+	LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(self->builder));
+	LLVMBasicBlockRef grow_block = LLVMAppendBasicBlock(func, "appendgrow");
+	LLVMBasicBlockRef store_block = LLVMAppendBasicBlock(func, "appendstore");
+	LLVMBasicBlockRef fast_block = LLVMGetInsertBlock(self->builder);
+	LLVMBuildCondBr(self->builder, LLVMBuildICmp(self->builder, LLVMIntUGT, need, cap, ""), grow_block, store_block);
+
+	LLVMPositionBuilderAtEnd(self->builder, grow_block);
+	LLVMValueRef args[5] = {
+		LLVMBuildPointerCast(self->builder, slice_ptr, LLVMTypeOf(LLVMGetParam(get_slice_grow_func(self), 0)), ""),
+		need,
+		LLVMSizeOf(element_type),
+		codegen_align_of(context, type->slice.type),
+		src ? LLVMBuildPointerCast(self->builder, src, int8ptr, "") : LLVMConstNull(int8ptr),
+	};
+	LLVMValueRef moved = LLVMBuildCall(self->builder, get_slice_grow_func(self), args, 5, "");
+	moved = LLVMBuildPointerCast(self->builder, moved, LLVMPointerType(element_type, 0), "");
+	LLVMBuildBr(self->builder, store_block);
+
+	//---- store the elements behind the last one
+	LLVMPositionBuilderAtEnd(self->builder, store_block);
+	if (src) {
+		LLVMValueRef phi = LLVMBuildPhi(self->builder, LLVMTypeOf(src), "");
+		LLVMAddIncoming(phi, (LLVMValueRef[]){src, moved}, (LLVMBasicBlockRef[]){fast_block, grow_block}, 2);
+		src = phi;
+	}
+	slice = LLVMBuildLoad(self->builder, slice_ptr, "");
+	LLVMValueRef dst = LLVMBuildExtractValue(self->builder, slice, 0, "arrptr");
+	dst = LLVMBuildInBoundsGEP(self->builder, dst, &len, 1, "");
+	if (expr->append.spread) {
+		LLVMValueRef size = LLVMBuildMul(self->builder, count, LLVMSizeOf(element_type), "");
+		LLVMBuildMemMove(self->builder, dst, 1, src, 1, size);
+	} else {
+		for (i = 0; i < num_values; ++i) {
+			LLVMValueRef index = LLVMConstInt(int64, i, 0);
+			codegen_store(self, context, values[i], LLVMBuildInBoundsGEP(self->builder, dst, &index, 1, ""), type->slice.type, 0);
+		}
+	}
+
+	slice = LLVMBuildInsertValue(self->builder, slice, need, 1, "len");
+	LLVMBuildStore(self->builder, slice, slice_ptr);
+	return slice;
+}
+
+/*
+ * Copies min(len(dst), len(src)) elements with a single memmove, such that the
+ * slices may overlap. Clamping the count to both lengths keeps the copy in
+ * bounds without checking every element.
+ */
+CODEGEN_EXPR(copy_builtin_expr) {
+	type_t *type = resolve_type_name(context, &expr->copy.dst->type);
+	LLVMTypeRef element_type = codegen_type(context, type->slice.type);
+
+	LLVMValueRef dst = codegen_expr(self, context, expr->copy.dst, 0, 0);
+	LLVMValueRef src = codegen_expr(self, context, expr->copy.src, 0, 0);
+	LLVMValueRef dst_len = LLVMBuildExtractValue(self->builder, dst, 1, "");
+	LLVMValueRef src_len = LLVMBuildExtractValue(self->builder, src, 1, "");
+	LLVMValueRef shorter = LLVMBuildICmp(self->builder, LLVMIntULT, src_len, dst_len, "");
+	LLVMValueRef count = LLVMBuildSelect(self->builder, shorter, src_len, dst_len, "count");
+
+	LLVMValueRef size = LLVMBuildMul(self->builder, count, LLVMSizeOf(element_type), "");
+	LLVMBuildMemMove(self->builder,
+		LLVMBuildExtractValue(self->builder, dst, 0, ""), 1,
+		LLVMBuildExtractValue(self->builder, src, 0, ""), 1, size);
+	return count;
 }
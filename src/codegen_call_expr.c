@@ -49,6 +49,11 @@ CODEGEN_EXPR(call_expr) {
 		exit(1);
 	}
 
+	// Within const declarations, calls to const functions are evaluated by
+	// the compiler. See codegen_interp.c.
+	if (self->const_eval && !lvalue && sym->kind == FUNC_SYMBOL && sym->func && sym->func->is_const)
+		return codegen_interp_call(context, expr);
+
 	unsigned i;
 	LLVMValueRef result;
 	if (sym->kind == INTERFACE_FUNCTION_SYMBOL) {
@@ -110,8 +115,8 @@ CODEGEN_EXPR(call_expr) {
 	}
 
 	if (lvalue) {
-		LLVMValueRef ptr = LLVMBuildAlloca(self->builder, LLVMTypeOf(result), "");
-		LLVMBuildStore(self->builder, result, ptr);
+		LLVMValueRef ptr = codegen_alloca(self, LLVMTypeOf(result), "");
+		codegen_store(self, context, result, ptr, &expr->type, 0);
 		return ptr;
 	} else {
 		return result;
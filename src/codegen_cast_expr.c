@@ -74,7 +74,9 @@ CODEGEN_EXPR(cast_expr) {
 								derror(&expr->loc, "type %s has no member named '%s' required by the interface %s", from_str, m->field.name, to_str);
 							if (!type_equal(m->field.type, resolved->strct.members[n].type))
 								derror(&expr->loc, "field '%s' is of the wrong type for interface %s", m->field.name, to_str);
-							fields[1+i] = LLVMBuildStructGEP(self->builder, LLVMConstNull(LLVMTypeOf(target)), n, "member");
+							if (resolved->strct.members[n].bits)
+								derror(&expr->loc, "bitfield '%s' cannot be a member of interface %s\n", m->field.name, to_str);
+							fields[1+i] = LLVMBuildStructGEP(self->builder, LLVMConstNull(LLVMTypeOf(target)), codegen_struct_field(context, resolved, n), "member");
 						} break;
 
 						default:
@@ -96,6 +98,29 @@ CODEGEN_EXPR(cast_expr) {
 		} else {
 			derror(&expr->loc, "only pointers can be cast to an interface\n");
 		}
+	} else if (to->pointer == 0 && to->kind == AST_VECTOR_TYPE) {
+		// Scalars are broadcast to all lanes, vectors of equal length are
+		// converted lane by lane.
+		if (type_equal(from, resolve_type_name(context, to->vector.type)))
+			return codegen_splat(self, target, to->vector.length);
+		if (from->pointer == 0 && from->kind == AST_VECTOR_TYPE && from->vector.length == to->vector.length) {
+			type_t *fe = resolve_type_name(context, from->vector.type);
+			type_t *te = resolve_type_name(context, to->vector.type);
+			if (fe->pointer == 0 && te->pointer == 0) {
+				if (fe->kind == AST_INTEGER_TYPE && te->kind == AST_INTEGER_TYPE)
+					return LLVMBuildIntCast2(self->builder, target, dst, !fe->is_unsigned, "");
+				if (fe->kind == AST_INTEGER_TYPE && te->kind == AST_BOOLEAN_TYPE)
+					return LLVMBuildICmp(self->builder, fe->is_unsigned ? LLVMIntNE : LLVMIntSGT, target, LLVMConstNull(LLVMTypeOf(target)), "");
+				if (fe->kind == AST_BOOLEAN_TYPE && te->kind == AST_INTEGER_TYPE)
+					return LLVMBuildZExt(self->builder, target, dst, "");
+				if (fe->kind == AST_INTEGER_TYPE && te->kind == AST_FLOAT_TYPE)
+					return fe->is_unsigned ? LLVMBuildUIToFP(self->builder, target, dst, "") : LLVMBuildSIToFP(self->builder, target, dst, "");
+				if (fe->kind == AST_FLOAT_TYPE && te->kind == AST_INTEGER_TYPE)
+					return te->is_unsigned ? LLVMBuildFPToUI(self->builder, target, dst, "") : LLVMBuildFPToSI(self->builder, target, dst, "");
+				if (fe->kind == AST_FLOAT_TYPE && te->kind == AST_FLOAT_TYPE)
+					return LLVMBuildFPCast(self->builder, target, dst, "");
+			}
+		}
 	} else if (from->pointer > 0) {
 		if (to->pointer > 0) {
 			return LLVMBuildPointerCast(self->builder, target, dst, "");
@@ -106,9 +131,10 @@ CODEGEN_EXPR(cast_expr) {
 		if (to->pointer > 0) {
 			return LLVMBuildIntToPtr(self->builder, target, dst, "");
 		} else if (to->kind == AST_INTEGER_TYPE) {
-			return LLVMBuildIntCast(self->builder, target, dst, "");
+			// Widening extends according to the signedness of the source.
+			return LLVMBuildIntCast2(self->builder, target, dst, !from->is_unsigned, "");
 		} else if (to->kind == AST_BOOLEAN_TYPE) {
-			return LLVMBuildICmp(self->builder, LLVMIntSGT, target, LLVMConstNull(LLVMTypeOf(target)), "");
+			return LLVMBuildICmp(self->builder, from->is_unsigned ? LLVMIntNE : LLVMIntSGT, target, LLVMConstNull(LLVMTypeOf(target)), "");
 		}
 	} else if (from->kind == AST_BOOLEAN_TYPE && to->pointer == 0) {
 		if (to->kind == AST_INTEGER_TYPE)
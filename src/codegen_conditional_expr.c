@@ -28,10 +28,12 @@ CODEGEN_EXPR(conditional_expr) {
 
 	LLVMPositionBuilderAtEnd(self->builder, true_block);
 	LLVMValueRef true_value = codegen_expr(self, context, expr->conditional.true_expr, 0, 0);
+	true_block = LLVMGetInsertBlock(self->builder);
 	LLVMBuildBr(self->builder, exit_block);
 
 	LLVMPositionBuilderAtEnd(self->builder, false_block);
 	LLVMValueRef false_value = codegen_expr(self, context, expr->conditional.false_expr, 0, 0);
+	false_block = LLVMGetInsertBlock(self->builder);
 	LLVMBuildBr(self->builder, exit_block);
 
 	// TODO: Make sure types of true and false branch match, otherwise cast.
@@ -0,0 +1,389 @@
+#include "codegen_internal.h"
+#include <math.h>
+
+/*
+ * Constant evaluation of expressions. After an expression has been prepared,
+ * codegen_const_eval determines whether its value is known at compile time
+ * and records it in the expression's `constant` field. Since preparation
+ * works bottom-up, the operands of an expression have already been evaluated
+ * at that point. codegen_expr emits known values directly as LLVM constants,
+ * such that folded expressions produce no instructions and may appear outside
+ * of functions, e.g. as the value of a const declaration.
+ *
+ * Expressions are only folded if codegen would accept them as well, such that
+ * all diagnostics are still issued during codegen.
+ */
+
+
+/// Sign-extends the lowest \a width bits of \a v.
+static long long
+wrap(unsigned long long v, unsigned width) {
+	if (width >= 64)
+		return v;
+	unsigned shift = 64 - width;
+	return (long long)(v << shift) >> shift;
+}
+
+/// Truncates \a v to the width of the integer type \a t and extends it
+/// according to the type's signedness.
+static long long
+wrap_int(unsigned long long v, const type_t *t) {
+	if (t->is_unsigned && t->width < 64)
+		return v & ((1ULL << t->width) - 1);
+	return wrap(v, t->width);
+}
+
+static double
+round_float(double f, unsigned width) {
+	return width == 32 ? (float)f : f;
+}
+
+static int
+parse_literal(expr_t *expr, type_t *type, const_value_t *out) {
+	const char *literal = expr->number_literal.literal;
+	char *end;
+	if (type->kind == AST_INTEGER_TYPE) {
+		out->i = wrap_int(strtoull(literal, &end, expr->number_literal.radix), type);
+	} else if (type->kind == AST_FLOAT_TYPE) {
+		out->f = round_float(strtod(literal, &end), type->width);
+	} else if (type->kind == AST_BOOLEAN_TYPE) {
+		out->i = strtoull(literal, &end, 10);
+		if (out->i > 1)
+			return 0;
+	} else {
+		return 0;
+	}
+	return *end == 0;
+}
+
+/*
+ * The following functions apply an operation to known values of the given,
+ * resolved type. They return 0 if the result cannot be determined at compile
+ * time. The compile-time function interpreter uses them as well.
+ */
+
+int
+codegen_const_unary(unsigned op, type_t *type, const const_value_t *a, const_value_t *out) {
+	if (type->pointer > 0)
+		return 0;
+	switch (op) {
+		case AST_POSITIVE:
+			*out = *a;
+			return type->kind == AST_INTEGER_TYPE || type->kind == AST_FLOAT_TYPE;
+		case AST_NEGATIVE:
+			if (type->kind == AST_INTEGER_TYPE)
+				out->i = wrap_int(-(unsigned long long)a->i, type);
+			else if (type->kind == AST_FLOAT_TYPE)
+				out->f = -a->f;
+			else
+				return 0;
+			return 1;
+		case AST_BITWISE_NOT:
+			out->i = wrap_int(~a->i, type);
+			return type->kind == AST_INTEGER_TYPE;
+		case AST_NOT:
+			out->i = !a->i;
+			return type->kind == AST_BOOLEAN_TYPE;
+		default:
+			return 0;
+	}
+}
+
+int
+codegen_const_binary(unsigned op, type_t *t, const const_value_t *va, const const_value_t *vb, const_value_t *out) {
+	if (t->pointer > 0)
+		return 0;
+	long long a = va->i, b = vb->i;
+	unsigned long long ua = a, ub = b;
+	unsigned w = t->width;
+
+	if (t->kind == AST_BOOLEAN_TYPE) {
+		switch (op) {
+			case AST_EQ:  out->i = a == b; return 1;
+			case AST_NE:  out->i = a != b; return 1;
+			case AST_AND: out->i = a && b; return 1;
+			case AST_OR:  out->i = a || b; return 1;
+			default: return 0;
+		}
+	} else if (t->kind == AST_INTEGER_TYPE) {
+		// Unsigned values are kept zero-extended, such that their unsigned
+		// 64 bit representation compares and divides correctly.
+		int u = t->is_unsigned;
+		switch (op) {
+			case AST_ADD: out->i = wrap_int(ua + ub, t); return 1;
+			case AST_SUB: out->i = wrap_int(ua - ub, t); return 1;
+			case AST_MUL: out->i = wrap_int(ua * ub, t); return 1;
+			case AST_DIV:
+			case AST_MOD:
+				// Leave division by zero and overflowing divisions to the
+				// target's behaviour at runtime.
+				if (b == 0 || (!u && b == -1 && a == wrap(1ULL << (w-1), w)))
+					return 0;
+				if (u)
+					out->i = op == AST_DIV ? ua / ub : ua % ub;
+				else
+					out->i = op == AST_DIV ? a / b : a % b;
+				return 1;
+			case AST_LEFT:
+			case AST_RIGHT:
+				if (b < 0 || b >= w)
+					return 0;
+				if (op == AST_LEFT)
+					out->i = wrap_int(ua << b, t);
+				else
+					out->i = u ? (long long)(ua >> b) : a >> b;
+				return 1;
+			case AST_LT: out->i = u ? ua < ub  : a < b;  return 1;
+			case AST_GT: out->i = u ? ua > ub  : a > b;  return 1;
+			case AST_LE: out->i = u ? ua <= ub : a <= b; return 1;
+			case AST_GE: out->i = u ? ua >= ub : a >= b; return 1;
+			case AST_EQ: out->i = a == b; return 1;
+			case AST_NE: out->i = a != b; return 1;
+			case AST_BITWISE_AND: out->i = a & b; return 1;
+			case AST_BITWISE_XOR: out->i = a ^ b; return 1;
+			case AST_BITWISE_OR:  out->i = a | b; return 1;
+			default: return 0;
+		}
+	} else if (t->kind == AST_FLOAT_TYPE) {
+		double fa = va->f, fb = vb->f;
+		switch (op) {
+			case AST_ADD: out->f = round_float(fa + fb, w); return 1;
+			case AST_SUB: out->f = round_float(fa - fb, w); return 1;
+			case AST_MUL: out->f = round_float(fa * fb, w); return 1;
+			case AST_DIV: out->f = round_float(fa / fb, w); return 1;
+			case AST_MOD: out->f = round_float(fmod(fa, fb), w); return 1;
+			// The comparisons are ordered, i.e. false if either side is NaN.
+			case AST_LT: out->i = fa < fb;  return 1;
+			case AST_GT: out->i = fa > fb;  return 1;
+			case AST_LE: out->i = fa <= fb; return 1;
+			case AST_GE: out->i = fa >= fb; return 1;
+			case AST_EQ: out->i = fa == fb; return 1;
+			case AST_NE: out->i = fa < fb || fa > fb; return 1;
+			default: return 0;
+		}
+	}
+	return 0;
+}
+
+int
+codegen_const_cast(type_t *from, type_t *to, const const_value_t *a, const_value_t *out) {
+	if (type_equal(from, to)) {
+		*out = *a;
+		return 1;
+	}
+	if (to->kind == AST_INTERFACE_TYPE)
+		return 0;
+
+	// Pointers are represented by their address and never dereferenced, so
+	// they may be freely converted to and from integers.
+	if (from->pointer > 0 || from->kind == AST_INTEGER_TYPE) {
+		unsigned from_width = from->pointer > 0 ? 64 : from->width;
+		if (to->pointer > 0) {
+			out->i = from_width < 64 ? a->i & ((1ULL << from_width) - 1) : a->i;
+			return 1;
+		} else if (to->kind == AST_INTEGER_TYPE) {
+			out->i = wrap_int(a->i, to);
+			return 1;
+		} else if (to->kind == AST_BOOLEAN_TYPE && from->pointer == 0) {
+			out->i = from->is_unsigned ? a->i != 0 : a->i > 0;
+			return 1;
+		}
+	} else if (from->kind == AST_BOOLEAN_TYPE && to->pointer == 0 && to->kind == AST_INTEGER_TYPE) {
+		out->i = a->i;
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Applies a bit operation or optimizer hint of the intrinsic() builtin to
+ * scalars of the type of its first operand. The hints evaluate to their
+ * operand. Operations that access memory or vectors are not supported.
+ */
+int
+codegen_const_intrinsic(unsigned op, type_t *type, const const_value_t *args, const_value_t *out) {
+	if (type->pointer > 0)
+		return 0;
+	if (op == AST_INTRINSIC_EXPECT || op == AST_INTRINSIC_LIKELY || op == AST_INTRINSIC_UNLIKELY) {
+		*out = args[0];
+		return 1;
+	}
+	if (type->kind != AST_INTEGER_TYPE)
+		return 0;
+
+	unsigned i, w = type->width;
+	unsigned long long mask = w < 64 ? (1ULL << w) - 1 : ~0ULL;
+	unsigned long long a = args[0].i & mask, b = a, s, r = 0;
+	switch (op) {
+		case AST_INTRINSIC_CTPOP:
+			for (; a; a &= a - 1)
+				++r;
+			break;
+		case AST_INTRINSIC_CTTZ:
+			while (r < w && !(a >> r & 1))
+				++r;
+			break;
+		case AST_INTRINSIC_CTLZ:
+			while (r < w && !(a >> (w - 1 - r) & 1))
+				++r;
+			break;
+		case AST_INTRINSIC_BSWAP:
+			for (i = 0; i < w; i += 8)
+				r |= (a >> i & 0xff) << (w - 8 - i);
+			break;
+
+		// Funnel shifts shift the concatenation of a and b by s modulo the
+		// width; rotations are funnel shifts of a value with itself.
+		case AST_INTRINSIC_FSHL:
+		case AST_INTRINSIC_FSHR:
+		case AST_INTRINSIC_ROTL:
+		case AST_INTRINSIC_ROTR: {
+			int funnel = op == AST_INTRINSIC_FSHL || op == AST_INTRINSIC_FSHR;
+			if (funnel)
+				b = args[1].i & mask;
+			s = (args[funnel ? 2 : 1].i & mask) % w;
+			if (op == AST_INTRINSIC_FSHL || op == AST_INTRINSIC_ROTL)
+				r = s ? a << s | b >> (w - s) : a;
+			else
+				r = s ? b >> s | a << (w - s) : b;
+			break;
+		}
+
+		default:
+			return 0;
+	}
+	out->i = wrap_int(r, type);
+	return 1;
+}
+
+
+static int
+eval_unary(expr_t *expr, type_t *type, const_value_t *out) {
+	const_value_t *a = &expr->unary_op.target->constant;
+	return a->known && codegen_const_unary(expr->unary_op.op, type, a, out);
+}
+
+static int
+eval_binary(codegen_context_t *context, expr_t *expr, const_value_t *out) {
+	expr_t *lhs = expr->binary_op.lhs;
+	expr_t *rhs = expr->binary_op.rhs;
+	if (!lhs->constant.known || !rhs->constant.known || !type_equal(&lhs->type, &rhs->type))
+		return 0;
+	type_t *t = resolve_type_name(context, &lhs->type);
+	return codegen_const_binary(expr->binary_op.op, t, &lhs->constant, &rhs->constant, out);
+}
+
+static int
+eval_cast(codegen_context_t *context, expr_t *expr, const_value_t *out) {
+	const_value_t *a = &expr->cast.target->constant;
+	if (!a->known)
+		return 0;
+	type_t *from = resolve_type_name(context, &expr->cast.target->type);
+	type_t *to = resolve_type_name(context, &expr->cast.type);
+	return codegen_const_cast(from, to, a, out);
+}
+
+static int
+eval_intrinsic(codegen_context_t *context, expr_t *expr, const_value_t *out) {
+	const_value_t args[3];
+	unsigned i, n = expr->intrinsic.num_args;
+	if (n > 3)
+		return 0;
+	for (i = 0; i < n; ++i) {
+		if (!expr->intrinsic.args[i].constant.known)
+			return 0;
+		args[i] = expr->intrinsic.args[i].constant;
+	}
+	type_t *type = resolve_type_name(context, &expr->intrinsic.args[0].type);
+	return codegen_const_intrinsic(expr->intrinsic.op, type, args, out);
+}
+
+
+/*
+ * Determines whether the value of a prepared expression is known at compile
+ * time and records it in the `constant` field of the expression.
+ */
+void
+codegen_const_eval(codegen_context_t *context, expr_t *expr) {
+	const_value_t value;
+	bzero(&value, sizeof value);
+	bzero(&expr->constant, sizeof expr->constant);
+	if (expr->type.kind == AST_NO_TYPE)
+		return;
+	type_t *type = resolve_type_name(context, &expr->type);
+
+	int known = 0;
+	switch (expr->kind) {
+		case AST_NUMBER_LITERAL_EXPR:
+			known = type->pointer == 0 && parse_literal(expr, type, &value);
+			break;
+
+		case AST_IDENT_EXPR: {
+			if (strcmp(expr->ident, "true") == 0 || strcmp(expr->ident, "false") == 0) {
+				value.i = strcmp(expr->ident, "true") == 0;
+				known = 1;
+				break;
+			}
+			codegen_symbol_t *sym = codegen_context_find_symbol(context, expr->ident);
+			if (sym && sym->kind != FUNC_SYMBOL && sym->decl && sym->decl->kind == AST_CONST_DECL) {
+				expr_t *init = &sym->decl->cons.value;
+				if (init->constant.known && type_equal(&init->type, &expr->type)) {
+					value = init->constant;
+					known = 1;
+				}
+			}
+		} break;
+
+		case AST_UNARY_EXPR:
+			known = eval_unary(expr, type, &value);
+			break;
+
+		case AST_BINARY_EXPR:
+			known = eval_binary(context, expr, &value);
+			break;
+
+		case AST_CAST_EXPR:
+			known = eval_cast(context, expr, &value);
+			break;
+
+		case AST_INTRINSIC_BUILTIN:
+			known = eval_intrinsic(context, expr, &value);
+			break;
+
+		case AST_CONDITIONAL_EXPR: {
+			const_value_t *cond = &expr->conditional.condition->constant;
+			expr_t *chosen = cond->i ? expr->conditional.true_expr : expr->conditional.false_expr;
+			if (cond->known && chosen->constant.known && type_equal(&chosen->type, &expr->type)) {
+				value = chosen->constant;
+				known = 1;
+			}
+		} break;
+
+		default:
+			break;
+	}
+
+	if (known) {
+		expr->constant = value;
+		expr->constant.known = 1;
+	}
+}
+
+
+/*
+ * Returns the LLVM constant for an expression whose value is known.
+ */
+LLVMValueRef
+codegen_const_value(codegen_context_t *context, expr_t *expr) {
+	assert(expr->constant.known);
+	LLVMTypeRef type = codegen_type(context, &expr->type);
+	type_t *t = resolve_type_name(context, &expr->type);
+	if (t->pointer > 0) {
+		LLVMValueRef addr = LLVMConstInt(LLVMInt64Type(), expr->constant.i, 0);
+		return expr->constant.i == 0 ? LLVMConstNull(type) : LLVMConstIntToPtr(addr, type);
+	} else if (t->kind == AST_FLOAT_TYPE) {
+		return LLVMConstReal(type, expr->constant.f);
+	} else {
+		return LLVMConstInt(type, expr->constant.i, 1);
+	}
+}
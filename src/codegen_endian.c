@@ -0,0 +1,75 @@
+#include "codegen_internal.h"
+#include "llvm_intrinsics.h"
+
+/*
+ * Integer types with an explicit byte order, such as `uint32be` and
+ * `int16le`. Values of these types are kept in native byte order while they
+ * are computed with, such that arithmetic and casts treat them like any other
+ * integer. Only memory holds them in their declared byte order, so loads and
+ * stores swap the bytes of integers whose byte order differs from the
+ * target's.
+ */
+
+
+/*
+ * Returns whether values of a type are stored in the opposite byte order of
+ * the target.
+ */
+static int
+is_foreign(codegen_context_t *context, type_t *type) {
+	type_t *t = resolve_type_name(context, type);
+	if (t->pointer > 0 || t->kind != AST_INTEGER_TYPE || t->byte_order == AST_NATIVE_ORDER)
+		return 0;
+	int big = LLVMByteOrder(codegen_target_data()) == LLVMBigEndian;
+	return big != (t->byte_order == AST_BIG_ENDIAN);
+}
+
+static LLVMValueRef
+byte_swap(codegen_t *self, LLVMValueRef value) {
+	LLVMTypeRef type = LLVMTypeOf(value);
+	LLVMValueRef func = LLVMGetIntrinsicByID(self->module, LLVMIntrinsicIDBswap, &type, 1);
+	return LLVMBuildCall(self->builder, func, &value, 1, "");
+}
+
+
+/*
+ * Loads a value of the given type from memory. If \a align is non-zero, the
+ * memory is only assumed to be aligned to that many bytes.
+ */
+LLVMValueRef
+codegen_load(codegen_t *self, codegen_context_t *context, LLVMValueRef ptr, type_t *type, unsigned align) {
+	LLVMValueRef value = LLVMBuildLoad(self->builder, ptr, "");
+	if (align)
+		LLVMSetAlignment(value, align);
+	return is_foreign(context, type) ? byte_swap(self, value) : value;
+}
+
+/*
+ * Stores a value of the given type to memory. If \a align is non-zero, the
+ * memory is only assumed to be aligned to that many bytes.
+ */
+LLVMValueRef
+codegen_store(codegen_t *self, codegen_context_t *context, LLVMValueRef value, LLVMValueRef ptr, type_t *type, unsigned align) {
+	if (is_foreign(context, type))
+		value = byte_swap(self, value);
+	LLVMValueRef store = LLVMBuildStore(self->builder, value, ptr);
+	if (align)
+		LLVMSetAlignment(store, align);
+	return store;
+}
+
+/*
+ * Converts a constant of the given type between its native and in-memory
+ * representation, for use as the initializer of a global. Swapping bytes is
+ * its own inverse, so this works in either direction.
+ */
+LLVMValueRef
+codegen_memory_const(codegen_context_t *context, LLVMValueRef value, type_t *type) {
+	if (!is_foreign(context, type) || !LLVMIsAConstantInt(value))
+		return value;
+	unsigned i, width = LLVMGetIntTypeWidth(LLVMTypeOf(value));
+	unsigned long long v = LLVMConstIntGetZExtValue(value), swapped = 0;
+	for (i = 0; i < width / 8; ++i)
+		swapped |= ((v >> (8*i)) & 0xff) << (width - 8 - 8*i);
+	return LLVMConstInt(LLVMTypeOf(value), swapped, 0);
+}
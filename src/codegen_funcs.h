@@ -13,10 +13,17 @@ BOTH(conditional_expr);
 BOTH(free_builtin_expr);
 BOTH(ident_expr);
 BOTH(incdec_expr);
+BOTH(label_addr_expr);
 BOTH(index_access_expr);
 BOTH(index_slice_expr);
 BOTH(lencap_builtin_expr);
 BOTH(dispose_builtin_expr);
+BOTH(append_builtin_expr);
+BOTH(copy_builtin_expr);
+BOTH(shuffle_builtin_expr);
+BOTH(reduce_builtin_expr);
+BOTH(atomic_builtin_expr);
+BOTH(intrinsic_builtin_expr);
 BOTH(make_builtin_expr);
 BOTH(member_access_expr);
 BOTH(new_builtin_expr);
@@ -40,6 +47,12 @@ const prepare_expr_fn_t prepare_expr_fn[AST_NUM_EXPRS] = {
 	[AST_INDEX_ACCESS_EXPR]   = prepare_index_access_expr,
 	[AST_LENCAP_BUILTIN]      = prepare_lencap_builtin_expr,
 	[AST_DISPOSE_BUILTIN]     = prepare_dispose_builtin_expr,
+	[AST_APPEND_BUILTIN]      = prepare_append_builtin_expr,
+	[AST_COPY_BUILTIN]        = prepare_copy_builtin_expr,
+	[AST_SHUFFLE_BUILTIN]     = prepare_shuffle_builtin_expr,
+	[AST_REDUCE_BUILTIN]      = prepare_reduce_builtin_expr,
+	[AST_ATOMIC_BUILTIN]      = prepare_atomic_builtin_expr,
+	[AST_INTRINSIC_BUILTIN]   = prepare_intrinsic_builtin_expr,
 	[AST_MAKE_BUILTIN]        = prepare_make_builtin_expr,
 	[AST_MEMBER_ACCESS_EXPR]  = prepare_member_access_expr,
 	[AST_NEW_BUILTIN]         = prepare_new_builtin_expr,
@@ -48,6 +61,7 @@ const prepare_expr_fn_t prepare_expr_fn[AST_NUM_EXPRS] = {
 	[AST_STRING_LITERAL_EXPR] = prepare_string_literal_expr,
 	[AST_UNARY_EXPR]          = prepare_unary_expr,
 	[AST_INDEX_SLICE_EXPR]    = prepare_index_slice_expr,
+	[AST_LABEL_ADDR_EXPR]     = prepare_label_addr_expr,
 };
 
 
@@ -63,6 +77,12 @@ const codegen_expr_fn_t codegen_expr_fn[AST_NUM_EXPRS] = {
 	[AST_INDEX_ACCESS_EXPR]   = codegen_index_access_expr,
 	[AST_LENCAP_BUILTIN]      = codegen_lencap_builtin_expr,
 	[AST_DISPOSE_BUILTIN]     = codegen_dispose_builtin_expr,
+	[AST_APPEND_BUILTIN]      = codegen_append_builtin_expr,
+	[AST_COPY_BUILTIN]        = codegen_copy_builtin_expr,
+	[AST_SHUFFLE_BUILTIN]     = codegen_shuffle_builtin_expr,
+	[AST_REDUCE_BUILTIN]      = codegen_reduce_builtin_expr,
+	[AST_ATOMIC_BUILTIN]      = codegen_atomic_builtin_expr,
+	[AST_INTRINSIC_BUILTIN]   = codegen_intrinsic_builtin_expr,
 	[AST_MAKE_BUILTIN]        = codegen_make_builtin_expr,
 	[AST_MEMBER_ACCESS_EXPR]  = codegen_member_access_expr,
 	[AST_NEW_BUILTIN]         = codegen_new_builtin_expr,
@@ -71,6 +91,7 @@ const codegen_expr_fn_t codegen_expr_fn[AST_NUM_EXPRS] = {
 	[AST_STRING_LITERAL_EXPR] = codegen_string_literal_expr,
 	[AST_UNARY_EXPR]          = codegen_unary_expr,
 	[AST_INDEX_SLICE_EXPR]    = codegen_index_slice_expr,
+	[AST_LABEL_ADDR_EXPR]     = codegen_label_addr_expr,
 };
 
 
@@ -46,11 +46,13 @@ CODEGEN_EXPR(ident_expr) {
 		return sym->value;
 	} else if (sym->value) {
 		LLVMValueRef ptr = sym->value;
-		return lvalue ? ptr : LLVMBuildLoad(self->builder, ptr, "");
+		return lvalue ? ptr : codegen_load(self, context, ptr, &expr->type, 0);
 	} else {
 		assert(sym->decl && sym->decl->kind == AST_CONST_DECL && "expected identifier to be a const");
 		assert(!lvalue && "const is not a valid lvalue");
-		LLVMValueRef value = codegen_expr(self, context, &sym->decl->cons.value, 0, 0);
+		codegen_t cg = *self;
+		cg.const_eval = 1;
+		LLVMValueRef value = codegen_expr(&cg, context, &sym->decl->cons.value, 0, 0);
 		return value;
 	}
 }
@@ -12,13 +12,16 @@ CODEGEN_EXPR(incdec_expr) {
 	if (lvalue)
 		derror(&expr->loc, "result of increment/decrement operation is not a valid lvalue\n");
 
-	LLVMValueRef target = codegen_expr(self, context, expr->incdec_op.target, 1, 0);
+	codegen_bitfield_t bf;
+	int is_bitfield = codegen_bitfield(self, context, expr->incdec_op.target, &bf);
+	LLVMValueRef target = is_bitfield ? bf.ptr : codegen_expr(self, context, expr->incdec_op.target, 1, 0);
 	if (!target)
 		derror(&expr->loc, "expression is not a valid lvalue and thus cannot be incremented/decremented\n");
 	if (expr->type.kind != AST_INTEGER_TYPE)
 		derror(&expr->loc, "increment/decrement operator only supported for integers\n");
 
-	LLVMValueRef value = LLVMBuildLoad(self->builder, target, "");
+	unsigned align = codegen_member_align(context, expr->incdec_op.target);
+	LLVMValueRef value = is_bitfield ? codegen_bitfield_load(self, &bf) : codegen_load(self, context, target, &expr->type, align);
 	LLVMValueRef const_one = LLVMConstInt(codegen_type(context, &expr->type), 1, 0);
 	LLVMValueRef new_value;
 	if (expr->incdec_op.direction == AST_INC) {
@@ -27,6 +30,9 @@ CODEGEN_EXPR(incdec_expr) {
 		new_value = LLVMBuildSub(self->builder, value, const_one, "");
 	}
 
-	LLVMBuildStore(self->builder, new_value, target);
+	if (is_bitfield)
+		codegen_bitfield_store(self, &bf, new_value);
+	else
+		codegen_store(self, context, new_value, target, &expr->type, align);
 	return expr->incdec_op.order == AST_PRE ? new_value : value;
 }
@@ -1,28 +1,97 @@
 /* Copyright (c) 2015-2016 Fabian Schuiki, Thomas Richner */
 #include "codegen_internal.h"
-#include "llvm_intrinsics.h"
-
-
-static void
-build_assert(codegen_t *self,codegen_context_t *context, LLVMValueRef cond){
-	LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(self->builder));
-	LLVMBasicBlockRef true_block = LLVMAppendBasicBlock(func, "iftrue");
-	LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(func, "ifexit");
-
-	cond = LLVMBuildNot(self->builder,cond,"");
-	LLVMBuildCondBr(self->builder, cond, true_block, exit_block);
-
-	LLVMPositionBuilderAtEnd(self->builder, true_block);
-
-	LLVMValueRef fn = LLVMGetIntrinsicByID(self->module,LLVMIntrinsicIDTrap,0,0);
-
-	assert(fn && "Intrinsic function not found!");
+#include "options.h"
+
+
+/*
+ * Returns the handler that is called when a runtime check fails in the report
+ * mode of the --checks option:
+ *
+ *     func low_check_failed(file *int8, line int32, index int64) void
+ *
+ * The handler must not return. If the program does not define it, a weak
+ * default is generated that prints the location and aborts.
+ */
+static LLVMValueRef
+get_check_handler(codegen_t *self){
+	static const char *name = "low_check_failed";
+	LLVMTypeRef int8ptr = LLVMPointerType(LLVMInt8Type(), 0);
+	LLVMTypeRef args[3] = { int8ptr, LLVMInt32Type(), LLVMInt64Type() };
+	LLVMTypeRef type = LLVMFunctionType(LLVMVoidType(), args, 3, 0);
+	LLVMValueRef fn = LLVMGetNamedFunction(self->module, name);
+	if (fn)
+		return LLVMConstPointerCast(fn, LLVMPointerType(type, 0));
+
+	fn = LLVMAddFunction(self->module, name, type);
+	LLVMSetLinkage(fn, LLVMWeakAnyLinkage);
+
+	LLVMBuilderRef builder = LLVMCreateBuilder();
+	LLVMPositionBuilderAtEnd(builder, LLVMAppendBasicBlock(fn, "entry"));
+	LLVMTypeRef dprintf_args[2] = { LLVMInt32Type(), int8ptr };
+	LLVMValueRef dprintf = LLVMGetNamedFunction(self->module, "dprintf");
+	if (!dprintf)
+		dprintf = LLVMAddFunction(self->module, "dprintf", LLVMFunctionType(LLVMInt32Type(), dprintf_args, 2, 1));
+	LLVMValueRef abort = LLVMGetNamedFunction(self->module, "abort");
+	if (!abort)
+		abort = LLVMAddFunction(self->module, "abort", LLVMFunctionType(LLVMVoidType(), 0, 0, 0));
+	LLVMValueRef dprintf_params[5] = {
+		LLVMConstInt(LLVMInt32Type(), 2, 0),
+		LLVMBuildGlobalStringPtr(builder, "%s:%d: index %lld out of bounds\n", ""),
+		LLVMGetParam(fn, 0),
+		LLVMGetParam(fn, 1),
+		LLVMGetParam(fn, 2),
+	};
+	LLVMBuildCall(builder, dprintf, dprintf_params, 5, "");
+	LLVMBuildCall(builder, abort, 0, 0, "");
+	LLVMBuildUnreachable(builder);
+	LLVMDisposeBuilder(builder);
+	return fn;
+}
 
-	LLVMBuildCall(self->builder,fn,0,0,"");
+/*
+ * Emits a runtime check that `cond` holds for an access with the given index.
+ * Depending on the --checks option, a failing check either branches to the
+ * function's shared trap block, or reports its location and the index through
+ * get_check_handler. The branch is weighted such that the passing case is laid
+ * out as the fall-through.
+ */
+void
+codegen_check(codegen_t *self, LLVMValueRef cond, loc_t *loc, LLVMValueRef index){
+	assert(self->trap_block && "runtime check outside of a function");
+	LLVMBasicBlockRef block = LLVMGetInsertBlock(self->builder);
+	LLVMValueRef func = LLVMGetBasicBlockParent(block);
+	LLVMBasicBlockRef fail_block = self->trap_block;
+	if (options.checks == CHECKS_REPORT)
+		fail_block = LLVMAppendBasicBlock(func, "checkfailed");
+	LLVMBasicBlockRef pass_block = LLVMAppendBasicBlock(func, "checked");
+
+	LLVMValueRef br = LLVMBuildCondBr(self->builder, cond, pass_block, fail_block);
+	LLVMValueRef weights[3] = {
+		LLVMMDString("branch_weights", 14),
+		LLVMConstInt(LLVMInt32Type(), 2000, 0),
+		LLVMConstInt(LLVMInt32Type(), 1, 0),
+	};
+	LLVMSetMetadata(br, LLVMGetMDKindID("prof", 4), LLVMMDNode(weights, 3));
+
+	if (options.checks == CHECKS_REPORT) {
+		LLVMPositionBuilderAtEnd(self->builder, fail_block);
+		LLVMValueRef args[3] = {
+			LLVMBuildGlobalStringPtr(self->builder, loc->filename ? loc->filename : "", ""),
+			LLVMConstInt(LLVMInt32Type(), loc->line+1, 0),
+			index,
+		};
+		LLVMBuildCall(self->builder, get_check_handler(self), args, 3, "");
+		LLVMBuildUnreachable(self->builder);
+	}
 
-	LLVMBuildBr(self->builder, exit_block);
+	// The failing branch never returns, so any access that the enclosing
+	// loops see as emitted in every iteration still is.
+	bounds_fact_t *fact;
+	for (fact = self->bounds_facts; fact; fact = fact->prev)
+		if (fact->straight == block)
+			fact->straight = pass_block;
 
-	LLVMPositionBuilderAtEnd(self->builder, exit_block);
+	LLVMPositionBuilderAtEnd(self->builder, pass_block);
 }
 
 
@@ -38,6 +107,11 @@ PREPARE_EXPR(index_access_expr) {
 		type_copy(&expr->type, target->array.type);
 	} else if (target->kind == AST_SLICE_TYPE) {
 		type_copy(&expr->type, target->slice.type);
+	} else if (target->kind == AST_VECTOR_TYPE) {
+		expr_t *index = expr->index_access.index;
+		if (index->constant.known && (index->constant.i < 0 || index->constant.i >= target->vector.length))
+			derror(&index->loc, "lane %lld out of range, vector has %u lanes\n", index->constant.i, target->vector.length);
+		type_copy(&expr->type, target->vector.type);
 	} else {
 		derror(&expr->loc, "cannot index into non-pointer\n");
 	}
@@ -47,17 +121,30 @@ PREPARE_EXPR(index_access_expr) {
 CODEGEN_EXPR(index_access_expr) {
 	type_t *target_type = resolve_type_name(context, &expr->index_access.target->type);
 	bool is_array = (target_type->pointer == 0 && target_type->kind == AST_ARRAY_TYPE);
-	LLVMValueRef target = codegen_expr(self, context, expr->index_access.target, is_array, 0);
+	bool is_vector = (target_type->pointer == 0 && target_type->kind == AST_VECTOR_TYPE);
+	LLVMValueRef target = codegen_expr(self, context, expr->index_access.target, is_array || (is_vector && lvalue), 0);
 	LLVMValueRef index = codegen_expr(self, context, expr->index_access.index, 0, 0);
 	if (expr->index_access.index->type.kind != AST_INTEGER_TYPE) {
 		derror(&expr->index_access.index->loc, "index needs to be an integer\n");
 	}
 
+	// Lanes of vector values are extracted directly, only assignments to a
+	// lane go through memory.
+	if (is_vector && !lvalue)
+		return LLVMBuildExtractElement(self->builder, target, index, "");
+
+	// GEP treats indices as signed, so unsigned ones are zero-extended first.
+	type_t *index_type = resolve_type_name(context, &expr->index_access.index->type);
+	if (index_type->is_unsigned)
+		index = LLVMBuildIntCast2(self->builder, index, LLVMInt64Type(), 0, "");
+
 	LLVMValueRef ptr;
 	if (target_type->pointer > 0) {
 		ptr = LLVMBuildInBoundsGEP(self->builder, target, &index, 1, "");
 	} else if (target_type->kind == AST_ARRAY_TYPE) {
 		ptr = LLVMBuildInBoundsGEP(self->builder, target, (LLVMValueRef[]){LLVMConstNull(LLVMInt32Type()), index}, 2, "");
+	} else if (target_type->kind == AST_VECTOR_TYPE) {
+		ptr = LLVMBuildGEP(self->builder, target, (LLVMValueRef[]){LLVMConstNull(LLVMInt32Type()), index}, 2, "");
 	} else if (target_type->kind == AST_SLICE_TYPE) {
 
 		LLVMValueRef cap = LLVMBuildExtractValue(self->builder, target, 2, "cap");
@@ -65,9 +152,12 @@ CODEGEN_EXPR(index_access_expr) {
 
 		index = LLVMBuildIntCast(self->builder, index, dst, "");
 
-		// check idx vs cap
-		LLVMValueRef oob = LLVMBuildICmp(self->builder, LLVMIntULT, index, cap, "");
-		build_assert(self,context,oob);
+		// check idx vs cap, unless disabled or an enclosing loop guarantees it
+		if (options.checks != CHECKS_NONE && !self->unchecked &&
+		    !codegen_bounds_known(self, context, expr->index_access.target, expr->index_access.index)) {
+			LLVMValueRef oob = LLVMBuildICmp(self->builder, LLVMIntULT, index, cap, "");
+			codegen_check(self, oob, &expr->loc, index);
+		}
 
 		LLVMValueRef arrptr = LLVMBuildExtractValue(self->builder, target, 0, "ptr");
 
@@ -76,5 +166,5 @@ CODEGEN_EXPR(index_access_expr) {
 	} else {
 		derror(&expr->loc, "cannot index into non-pointer or non-array");
 	}
-	return lvalue ? ptr : LLVMBuildLoad(self->builder, ptr, "");
+	return lvalue ? ptr : codegen_load(self, context, ptr, &expr->type, codegen_member_align(context, expr));
 }
@@ -1,5 +1,6 @@
 /* Copyright (c) 2015-2016 Fabian Schuiki, Thomas Richner */
 #include "codegen_internal.h"
+#include "options.h"
 
 
 PREPARE_EXPR(index_slice_expr) {
@@ -28,13 +29,30 @@ PREPARE_EXPR(index_slice_expr) {
 }
 
 
+/*
+ * Emits a check that `start <= cap` and `end <= cap` for a slicing operation,
+ * unless checks are disabled. An end before the start still yields an empty
+ * slice. Indexing relies on a slice's length never exceeding its capacity, see
+ * codegen_bounds.c.
+ */
+static void
+check_slice_range(codegen_t *self, expr_t *expr, LLVMValueRef start, LLVMValueRef end, LLVMValueRef cap) {
+	if (options.checks == CHECKS_NONE || self->unchecked)
+		return;
+	LLVMValueRef start_fits = LLVMBuildICmp(self->builder, LLVMIntULE, start, cap, "");
+	LLVMValueRef end_fits = LLVMBuildICmp(self->builder, LLVMIntULE, end, cap, "");
+	codegen_check(self, LLVMBuildAnd(self->builder, start_fits, end_fits, ""), &expr->loc, end);
+}
+
 /* Slices an existing slice.
  *
  * New values:
- * ncap = end - start
- * nlen = max(len - start,0)
+ * ncap = cap - start
+ * nlen = max(end - start,0)
  * narrptr = arrptr + start
  * nbaseptr = baseptr
+ * nowned = owned && start == 0, since the memory can only be resized through
+ *          a slice that begins at baseptr
  */
 static LLVMValueRef slice_slice(codegen_t *self, codegen_context_t *context, expr_t *expr) {
 	LLVMValueRef target = codegen_expr(self, context, expr->index_slice.target, 0, 0);
@@ -72,8 +90,11 @@ static LLVMValueRef slice_slice(codegen_t *self, codegen_context_t *context, exp
 
 	LLVMTypeRef tcap = LLVMTypeOf(cap);
 
-	start = LLVMBuildIntCast(self->builder, start, tcap,"");
-	end = LLVMBuildIntCast(self->builder, end, tcap,"");
+	int start_signed = !expr->index_slice.start || !expr->index_slice.start->type.is_unsigned;
+	int end_signed = !expr->index_slice.end || !expr->index_slice.end->type.is_unsigned;
+	start = LLVMBuildIntCast2(self->builder, start, tcap, start_signed, "");
+	end = LLVMBuildIntCast2(self->builder, end, tcap, end_signed, "");
+	check_slice_range(self, expr, start, end, cap);
 
 	//---- calc new len/cap
 	LLVMValueRef ncap = LLVMBuildSub(self->builder, cap, start, "");
@@ -83,6 +104,8 @@ static LLVMValueRef slice_slice(codegen_t *self, codegen_context_t *context, exp
 	LLVMValueRef arrptr = LLVMBuildExtractValue(self->builder, target, 0, "");
 	LLVMValueRef ptr = LLVMBuildInBoundsGEP(self->builder, arrptr, &start, 1, "");
 	LLVMValueRef baseptr = LLVMBuildExtractValue(self->builder, target, 3, "");
+	LLVMValueRef owned = LLVMBuildExtractValue(self->builder, target, 4, "");
+	owned = LLVMBuildAnd(self->builder, owned, LLVMBuildICmp(self->builder, LLVMIntEQ, start, zero, ""), "nowned");
 
 	//---- assemble new struct
 	LLVMTypeRef tslice = LLVMTypeOf(target);
@@ -91,6 +114,7 @@ static LLVMValueRef slice_slice(codegen_t *self, codegen_context_t *context, exp
 	slice = LLVMBuildInsertValue(self->builder, slice, ptr, 0, "slice");
 	slice = LLVMBuildInsertValue(self->builder, slice, ncap, 2, "slice");
 	slice = LLVMBuildInsertValue(self->builder, slice, baseptr, 3, "slice");
+	slice = LLVMBuildInsertValue(self->builder, slice, owned, 4, "slice");
 
 	//---- len = max(0, len)
 	LLVMValueRef cond = LLVMBuildICmp(self->builder, LLVMIntSGT,nlen,zero,"min");
@@ -149,6 +173,11 @@ static LLVMValueRef slice_array(codegen_t *self, codegen_context_t *context, exp
 	} else {
 		index_end = array_length;
 	}
+	int start_signed = !expr->index_slice.start || !expr->index_slice.start->type.is_unsigned;
+	int end_signed = !expr->index_slice.end || !expr->index_slice.end->type.is_unsigned;
+	index_start = LLVMBuildIntCast2(self->builder, index_start, LLVMInt64Type(), start_signed, "");
+	index_end = LLVMBuildIntCast2(self->builder, index_end, LLVMInt64Type(), end_signed, "");
+	check_slice_range(self, expr, index_start, index_end, array_length);
 
 	// Calculate the pointer to the first element of the slice, which can be
 	// obtained by shifting the array pointer index_start elements.
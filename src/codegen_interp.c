@@ -0,0 +1,690 @@
+#include "codegen_internal.h"
+
+/*
+ * Compile-time evaluation of const functions. A function declared as
+ *
+ *     const func crc_table() [256]uint32 { ... }
+ *
+ * may be called from the value of a const declaration, in which case the call
+ * is executed by the interpreter below and replaced with the constant it
+ * returns. This allows lookup tables to be computed by the compiler instead
+ * of at program startup.
+ *
+ * The interpreter walks the bodies of const functions after they have been
+ * generated, such that every expression is already prepared and carries its
+ * type. Only integers, floats, booleans, and arrays and structs thereof are
+ * supported. Anything that would touch memory, such as pointers, slices, or
+ * calls to regular functions, is reported as an error.
+ *
+ * The supported statements are expressions, blocks with local variable and
+ * const declarations, if, switch, for loops including the `for cond { ... }`
+ * form of a while loop, break, continue, return, and unchecked blocks. Labels
+ * and gotos are rejected, and the language has no do loop to support.
+ */
+
+/// Upper bound on the number of statements and loop iterations executed for
+/// a single const declaration, to catch functions that never return.
+#define MAX_STEPS 100000000
+/// Upper bound on the depth of nested calls.
+#define MAX_DEPTH 1000
+
+typedef struct interp_value interp_value_t;
+typedef struct interp_var interp_var_t;
+typedef struct interp interp_t;
+
+/// A value during interpretation. Scalars are kept in \a scalar, the elements
+/// of arrays and the members of structs in \a elems.
+struct interp_value {
+	const_value_t scalar;
+	unsigned num_elems;
+	interp_value_t *elems;
+};
+
+struct interp_var {
+	const char *name;
+	interp_value_t value;
+	/// The global the variable was loaded from, or null for locals.
+	LLVMValueRef global;
+};
+
+struct interp {
+	/// Context that identifiers not naming a local are looked up in.
+	codegen_context_t *context;
+	/// Local variables of all active calls, innermost last.
+	array_t vars;
+	/// Index of the first variable of the innermost call.
+	unsigned frame;
+	/// Consts loaded from the module, such that they are converted once.
+	array_t globals;
+	/// Value of the last return statement executed.
+	interp_value_t result;
+	unsigned long steps;
+	unsigned depth;
+	loc_t loc;
+};
+
+enum interp_flow {
+	FLOW_NEXT,
+	FLOW_BREAK,
+	FLOW_CONTINUE,
+	FLOW_RETURN,
+};
+
+
+static void
+value_dispose(interp_value_t *value) {
+	unsigned i;
+	for (i = 0; i < value->num_elems; ++i)
+		value_dispose(value->elems + i);
+	free(value->elems);
+	bzero(value, sizeof(*value));
+}
+
+static void
+value_copy(interp_value_t *dst, const interp_value_t *src) {
+	*dst = *src;
+	if (src->num_elems == 0)
+		return;
+	dst->elems = malloc(src->num_elems * sizeof(interp_value_t));
+	unsigned i;
+	for (i = 0; i < src->num_elems; ++i)
+		value_copy(dst->elems + i, src->elems + i);
+}
+
+static int
+is_scalar(type_t *type) {
+	return type->pointer == 0 && (
+		type->kind == AST_INTEGER_TYPE ||
+		type->kind == AST_FLOAT_TYPE ||
+		type->kind == AST_BOOLEAN_TYPE);
+}
+
+/// Returns whether a struct has bitfield members, which the interpreter does
+/// not model.
+static int
+has_bitfields(type_t *t) {
+	unsigned i;
+	for (i = 0; i < t->strct.num_members; ++i)
+		if (t->strct.members[i].bits)
+			return 1;
+	return 0;
+}
+
+static type_t *
+resolve(interp_t *self, type_t *type, loc_t *loc) {
+	type_t *t = resolve_type_name(self->context, type);
+	if (!is_scalar(t) && (t->pointer > 0 || (t->kind != AST_ARRAY_TYPE && t->kind != AST_STRUCT_TYPE) ||
+	    (t->kind == AST_STRUCT_TYPE && has_bitfields(t)))) {
+		char *td = type_describe(type);
+		derror(loc, "values of type %s cannot be computed at compile time\n", td);
+		free(td);
+	}
+	return t;
+}
+
+/// Initializes \a value to the zero value of \a type.
+static void
+value_zero(interp_t *self, interp_value_t *value, type_t *type, loc_t *loc) {
+	bzero(value, sizeof(*value));
+	type_t *t = resolve(self, type, loc);
+	unsigned i;
+	if (t->kind == AST_ARRAY_TYPE) {
+		value->num_elems = t->array.length;
+		value->elems = malloc(t->array.length * sizeof(interp_value_t));
+		if (t->array.length > 0)
+			value_zero(self, value->elems, t->array.type, loc);
+		for (i = 1; i < t->array.length; ++i)
+			value_copy(value->elems + i, value->elems);
+	} else if (t->kind == AST_STRUCT_TYPE) {
+		value->num_elems = t->strct.num_members;
+		value->elems = malloc(t->strct.num_members * sizeof(interp_value_t));
+		for (i = 0; i < t->strct.num_members; ++i)
+			value_zero(self, value->elems + i, t->strct.members[i].type, loc);
+	}
+}
+
+/// Converts the initializer of a global constant to a value.
+static void
+value_from_llvm(interp_t *self, interp_value_t *value, type_t *type, LLVMValueRef c, loc_t *loc) {
+	type_t *t = resolve(self, type, loc);
+	if (LLVMIsNull(c)) {
+		value_zero(self, value, type, loc);
+		return;
+	}
+	bzero(value, sizeof(*value));
+	if (t->kind == AST_FLOAT_TYPE) {
+		LLVMBool loses_info;
+		value->scalar.f = LLVMConstRealGetDouble(c, &loses_info);
+	} else if (is_scalar(t)) {
+		c = codegen_memory_const(self->context, c, type);
+		value->scalar.i = t->kind == AST_BOOLEAN_TYPE ? LLVMConstIntGetZExtValue(c) : LLVMConstIntGetSExtValue(c);
+	} else {
+		value->num_elems = t->kind == AST_ARRAY_TYPE ? t->array.length : t->strct.num_members;
+		value->elems = malloc(value->num_elems * sizeof(interp_value_t));
+		unsigned i;
+		for (i = 0; i < value->num_elems; ++i) {
+			LLVMValueRef elem = LLVMIsAConstantDataSequential(c) ? LLVMGetElementAsConstant(c, i) :
+				LLVMGetOperand(c, t->kind == AST_ARRAY_TYPE ? i : codegen_struct_field(self->context, t, i));
+			value_from_llvm(self, value->elems + i, t->kind == AST_ARRAY_TYPE ? t->array.type : t->strct.members[i].type, elem, loc);
+		}
+	}
+}
+
+/// Converts a value to the corresponding LLVM constant. Elements of arrays and
+/// structs are in their in-memory byte order.
+static LLVMValueRef
+value_to_llvm(interp_t *self, const interp_value_t *value, type_t *type, loc_t *loc) {
+	type_t *t = resolve(self, type, loc);
+	LLVMTypeRef llvm_type = codegen_type(self->context, type);
+	if (t->kind == AST_FLOAT_TYPE)
+		return LLVMConstReal(llvm_type, value->scalar.f);
+	if (is_scalar(t))
+		return LLVMConstInt(llvm_type, value->scalar.i, 1);
+
+	unsigned i;
+	LLVMValueRef *elems = malloc(value->num_elems * sizeof(LLVMValueRef));
+	for (i = 0; i < value->num_elems; ++i) {
+		type_t *elem_type = t->kind == AST_ARRAY_TYPE ? t->array.type : t->strct.members[i].type;
+		elems[i] = codegen_memory_const(self->context, value_to_llvm(self, value->elems + i, elem_type, loc), elem_type);
+	}
+	LLVMValueRef result;
+	if (t->kind == AST_ARRAY_TYPE) {
+		result = LLVMConstArray(codegen_type(self->context, t->array.type), elems, value->num_elems);
+	} else {
+		// Structs with an explicit layout have padding fields between the
+		// members.
+		unsigned num_fields = LLVMCountStructElementTypes(llvm_type);
+		LLVMValueRef fields[num_fields];
+		for (i = 0; i < num_fields; ++i)
+			fields[i] = LLVMConstNull(LLVMStructGetTypeAtIndex(llvm_type, i));
+		for (i = 0; i < value->num_elems; ++i)
+			fields[codegen_struct_field(self->context, t, i)] = elems[i];
+		result = LLVMConstNamedStruct(llvm_type, fields, num_fields);
+	}
+	free(elems);
+	return result;
+}
+
+
+static void
+push_var(interp_t *self, const char *name, interp_value_t *value) {
+	interp_var_t *var = malloc(sizeof(interp_var_t));
+	bzero(var, sizeof(*var));
+	var->name = name;
+	var->value = *value;
+	array_add(&self->vars, &var);
+}
+
+static void
+pop_vars(interp_t *self, unsigned size) {
+	while (self->vars.size > size) {
+		interp_var_t *var = *(interp_var_t**)array_get(&self->vars, self->vars.size-1);
+		value_dispose(&var->value);
+		free(var);
+		array_remove(&self->vars);
+	}
+}
+
+/*
+ * Returns the storage of the variable an identifier refers to. Locals of the
+ * innermost call take precedence. Other identifiers must name a const, whose
+ * value is loaded once and may not be assigned to.
+ */
+static interp_value_t *
+lookup(interp_t *self, expr_t *expr, int assign) {
+	unsigned i;
+	for (i = self->vars.size; i > self->frame; --i) {
+		interp_var_t *var = *(interp_var_t**)array_get(&self->vars, i-1);
+		if (strcmp(var->name, expr->ident) == 0)
+			return &var->value;
+	}
+
+	codegen_symbol_t *sym = codegen_context_find_symbol(self->context, expr->ident);
+	if (!sym || sym->kind == FUNC_SYMBOL || !sym->decl || sym->decl->kind != AST_CONST_DECL || !sym->value)
+		derror(&expr->loc, "'%s' cannot be used at compile time since it is not a const\n", expr->ident);
+	if (assign)
+		derror(&expr->loc, "cannot assign to const '%s'\n", expr->ident);
+
+	for (i = 0; i < self->globals.size; ++i) {
+		interp_var_t *var = *(interp_var_t**)array_get(&self->globals, i);
+		if (var->global == sym->value)
+			return &var->value;
+	}
+	LLVMValueRef init = LLVMGetInitializer(sym->value);
+	if (!init)
+		derror(&expr->loc, "value of const '%s' is not known yet\n", expr->ident);
+	interp_var_t *var = malloc(sizeof(interp_var_t));
+	bzero(var, sizeof(*var));
+	var->name = expr->ident;
+	var->global = sym->value;
+	value_from_llvm(self, &var->value, sym->type, init, &expr->loc);
+	array_add(&self->globals, &var);
+	return &var->value;
+}
+
+static void eval(interp_t *self, expr_t *expr, interp_value_t *out);
+static enum interp_flow exec(interp_t *self, stmt_t *stmt);
+
+static long long
+eval_index(interp_t *self, expr_t *expr, unsigned length) {
+	interp_value_t index;
+	eval(self, expr->index_access.index, &index);
+	if (index.scalar.i < 0 || index.scalar.i >= length)
+		derror(&expr->loc, "index %lld is out of bounds for array of length %u\n", index.scalar.i, length);
+	return index.scalar.i;
+}
+
+static unsigned
+member_index(interp_t *self, expr_t *expr) {
+	type_t *t = resolve(self, &expr->member_access.target->type, &expr->loc);
+	unsigned i;
+	if (t->kind == AST_STRUCT_TYPE)
+		for (i = 0; i < t->strct.num_members; ++i)
+			if (strcmp(t->strct.members[i].name, expr->member_access.name) == 0)
+				return i;
+	derror(&expr->loc, "unknown member '%s'\n", expr->member_access.name);
+	return 0;
+}
+
+/*
+ * Returns the storage an lvalue expression refers to, or null if the
+ * expression does not refer to a variable. Indices are evaluated before the
+ * variable is looked up, since evaluating them may add variables.
+ */
+static interp_value_t *
+place(interp_t *self, expr_t *expr, int assign) {
+	interp_value_t *target;
+	switch (expr->kind) {
+		case AST_IDENT_EXPR:
+			if (strcmp(expr->ident, "true") == 0 || strcmp(expr->ident, "false") == 0)
+				return 0;
+			return lookup(self, expr, assign);
+
+		case AST_INDEX_ACCESS_EXPR: {
+			type_t *t = resolve(self, &expr->index_access.target->type, &expr->loc);
+			if (t->kind != AST_ARRAY_TYPE)
+				derror(&expr->loc, "only arrays can be indexed at compile time\n");
+			long long index = eval_index(self, expr, t->array.length);
+			target = place(self, expr->index_access.target, assign);
+			return target ? target->elems + index : 0;
+		}
+
+		case AST_MEMBER_ACCESS_EXPR: {
+			unsigned index = member_index(self, expr);
+			target = place(self, expr->member_access.target, assign);
+			return target ? target->elems + index : 0;
+		}
+
+		default:
+			return 0;
+	}
+}
+
+static void
+call(interp_t *self, expr_t *expr, interp_value_t *out) {
+	codegen_symbol_t *sym = 0;
+	if (expr->call.target->kind == AST_IDENT_EXPR)
+		sym = codegen_context_find_symbol(self->context, expr->call.target->ident);
+	if (!sym || sym->kind != FUNC_SYMBOL || !sym->func || !sym->func->is_const)
+		derror(&expr->loc, "only const functions can be called at compile time\n");
+	func_unit_t *func = sym->func;
+	if (!func->body || LLVMCountBasicBlocks(sym->value) == 0)
+		derror(&expr->loc, "const function '%s' is called before its body is known\n", func->name);
+	if (self->depth == MAX_DEPTH)
+		derror(&self->loc, "compile-time evaluation exceeds %u nested calls\n", MAX_DEPTH);
+
+	// Evaluate the arguments in the caller's frame before entering the
+	// callee's.
+	unsigned i;
+	interp_value_t args[expr->call.num_args];
+	for (i = 0; i < expr->call.num_args; ++i)
+		eval(self, expr->call.args + i, args + i);
+
+	// The callee only sees its own locals and the module's declarations.
+	codegen_context_t *context = self->context;
+	while (self->context->prev)
+		self->context = self->context->prev;
+	unsigned frame = self->frame;
+	self->frame = self->vars.size;
+	++self->depth;
+	for (i = 0; i < func->num_params; ++i)
+		push_var(self, func->params[i].name, args + i);
+
+	if (exec(self, func->body) != FLOW_RETURN)
+		derror(&expr->loc, "const function '%s' did not return a value\n", func->name);
+	*out = self->result;
+	bzero(&self->result, sizeof(self->result));
+
+	pop_vars(self, self->frame);
+	self->frame = frame;
+	self->context = context;
+	--self->depth;
+}
+
+static void
+assign(interp_t *self, expr_t *expr, interp_value_t *out) {
+	interp_value_t value;
+	eval(self, expr->assignment.expr, &value);
+	interp_value_t *target = place(self, expr->assignment.target, 1);
+	if (!target)
+		derror(&expr->loc, "expression cannot be assigned a value\n");
+
+	if (expr->assignment.op == AST_ASSIGN) {
+		value_dispose(target);
+		value_copy(target, &value);
+		*out = value;
+		return;
+	}
+
+	// Mirror the operations supported by codegen_assignment_expr.
+	type_t *t = resolve(self, &expr->type, &expr->loc);
+	const_value_t a = target->scalar, b = value.scalar;
+	unsigned op;
+	switch (expr->assignment.op) {
+		case AST_ADD_ASSIGN: op = AST_ADD; break;
+		case AST_SUB_ASSIGN: op = AST_SUB; break;
+		case AST_MUL_ASSIGN: op = AST_MUL; break;
+		case AST_DIV_ASSIGN: op = AST_DIV; break;
+		default:
+			derror(&expr->loc, "assignment operator cannot be evaluated at compile time\n");
+			return;
+	}
+	if (!codegen_const_binary(op, t, &a, &b, &target->scalar))
+		derror(&expr->loc, "assignment cannot be evaluated at compile time\n");
+	*out = value;
+}
+
+/// Evaluates an expression into \a out, which the caller must dispose of.
+static void
+eval(interp_t *self, expr_t *expr, interp_value_t *out) {
+	bzero(out, sizeof(*out));
+	if (expr->constant.known) {
+		out->scalar = expr->constant;
+		return;
+	}
+
+	interp_value_t a, b;
+	interp_value_t *p;
+	type_t *t;
+	unsigned i;
+	switch (expr->kind) {
+		case AST_IDENT_EXPR:
+		case AST_INDEX_ACCESS_EXPR:
+		case AST_MEMBER_ACCESS_EXPR:
+			p = place(self, expr, 0);
+			if (p) {
+				value_copy(out, p);
+				return;
+			}
+			// Not a variable, e.g. a member of a returned struct.
+			if (expr->kind == AST_INDEX_ACCESS_EXPR) {
+				t = resolve(self, &expr->index_access.target->type, &expr->loc);
+				if (t->kind != AST_ARRAY_TYPE)
+					derror(&expr->loc, "only arrays can be indexed at compile time\n");
+				long long index = eval_index(self, expr, t->array.length);
+				eval(self, expr->index_access.target, &a);
+				value_copy(out, a.elems + index);
+			} else if (expr->kind == AST_MEMBER_ACCESS_EXPR) {
+				i = member_index(self, expr);
+				eval(self, expr->member_access.target, &a);
+				value_copy(out, a.elems + i);
+			} else {
+				break;
+			}
+			value_dispose(&a);
+			return;
+
+		case AST_CALL_EXPR:
+			call(self, expr, out);
+			return;
+
+		case AST_UNARY_EXPR:
+			t = resolve(self, &expr->type, &expr->loc);
+			eval(self, expr->unary_op.target, &a);
+			if (!is_scalar(t) || !codegen_const_unary(expr->unary_op.op, t, &a.scalar, &out->scalar))
+				break;
+			return;
+
+		case AST_BINARY_EXPR:
+			eval(self, expr->binary_op.lhs, &a);
+			if (expr->binary_op.op == AST_AND || expr->binary_op.op == AST_OR) {
+				if (a.scalar.i == (expr->binary_op.op == AST_OR)) {
+					out->scalar.i = a.scalar.i;
+					return;
+				}
+				eval(self, expr->binary_op.rhs, out);
+				return;
+			}
+			eval(self, expr->binary_op.rhs, &b);
+			t = resolve(self, &expr->binary_op.lhs->type, &expr->loc);
+			if (!is_scalar(t) || !codegen_const_binary(expr->binary_op.op, t, &a.scalar, &b.scalar, &out->scalar))
+				break;
+			return;
+
+		case AST_CAST_EXPR:
+			eval(self, expr->cast.target, &a);
+			t = resolve(self, &expr->cast.target->type, &expr->loc);
+			if (!is_scalar(t) || !codegen_const_cast(t, resolve(self, &expr->cast.type, &expr->loc), &a.scalar, &out->scalar))
+				break;
+			return;
+
+		case AST_INTRINSIC_BUILTIN: {
+			const_value_t args[3];
+			if (expr->intrinsic.num_args > 3)
+				break;
+			for (i = 0; i < expr->intrinsic.num_args; ++i) {
+				eval(self, expr->intrinsic.args + i, &a);
+				args[i] = a.scalar;
+			}
+			t = resolve(self, &expr->intrinsic.args[0].type, &expr->loc);
+			if (!is_scalar(t) || !codegen_const_intrinsic(expr->intrinsic.op, t, args, &out->scalar))
+				break;
+			return;
+		}
+
+		case AST_CONDITIONAL_EXPR:
+			eval(self, expr->conditional.condition, &a);
+			eval(self, a.scalar.i ? expr->conditional.true_expr : expr->conditional.false_expr, out);
+			return;
+
+		case AST_ASSIGNMENT_EXPR:
+			assign(self, expr, out);
+			return;
+
+		case AST_INCDEC_EXPR: {
+			p = place(self, expr->incdec_op.target, 1);
+			t = resolve(self, &expr->type, &expr->loc);
+			if (!p || t->kind != AST_INTEGER_TYPE)
+				break;
+			const_value_t one = { .i = 1 };
+			out->scalar = p->scalar;
+			codegen_const_binary(expr->incdec_op.direction == AST_INC ? AST_ADD : AST_SUB, t, &p->scalar, &one, &p->scalar);
+			if (expr->incdec_op.order == AST_PRE)
+				out->scalar = p->scalar;
+			return;
+		}
+
+		case AST_COMMA_EXPR:
+			for (i = 0; i + 1 < expr->comma.num_exprs; ++i) {
+				eval(self, expr->comma.exprs + i, &a);
+				value_dispose(&a);
+			}
+			eval(self, expr->comma.exprs + i, out);
+			return;
+
+		default:
+			break;
+	}
+	derror(&expr->loc, "expression cannot be evaluated at compile time\n");
+}
+
+
+static void
+step(interp_t *self) {
+	if (++self->steps > MAX_STEPS)
+		derror(&self->loc, "compile-time evaluation exceeds %u steps\n", MAX_STEPS);
+}
+
+/*
+ * Executes the cases of a switch statement's body, starting with the one
+ * that matches \a value.
+ */
+static enum interp_flow
+exec_switch(interp_t *self, stmt_t *stmt, long long value) {
+	stmt_t *body = stmt->selection.stmt;
+	assert(body && body->kind == AST_COMPOUND_STMT);
+	unsigned n = body->compound.num_items;
+
+	// Find the item labelled with a matching case, or else the default.
+	unsigned i, start = n, fallback = n;
+	for (i = 0; i < n && start == n; ++i) {
+		block_item_t *item = body->compound.items + i;
+		stmt_t *label = item->kind == AST_STMT_BLOCK_ITEM ? item->stmt : 0;
+		for (; label && (label->kind == AST_CASE_STMT || label->kind == AST_DEFAULT_STMT); label = label->label.stmt) {
+			if (label->kind == AST_DEFAULT_STMT)
+				fallback = i;
+			else if (label->label.expr->constant.i == value)
+				start = i;
+		}
+	}
+	if (start == n)
+		start = fallback;
+
+	for (i = start; i < n; ++i) {
+		block_item_t *item = body->compound.items + i;
+		if (item->kind != AST_STMT_BLOCK_ITEM || !item->stmt)
+			continue;
+		enum interp_flow flow = exec(self, item->stmt);
+		if (flow == FLOW_BREAK)
+			return FLOW_NEXT;
+		if (flow != FLOW_NEXT)
+			return flow;
+	}
+	return FLOW_NEXT;
+}
+
+static enum interp_flow
+exec(interp_t *self, stmt_t *stmt) {
+	step(self);
+	interp_value_t value;
+	enum interp_flow flow;
+	unsigned i, mark;
+	switch (stmt->kind) {
+		case AST_EXPR_STMT:
+			eval(self, stmt->expr, &value);
+			value_dispose(&value);
+			return FLOW_NEXT;
+
+		case AST_COMPOUND_STMT:
+			mark = self->vars.size;
+			flow = FLOW_NEXT;
+			for (i = 0; i < stmt->compound.num_items && flow == FLOW_NEXT; ++i) {
+				block_item_t *item = stmt->compound.items + i;
+				if (item->kind == AST_STMT_BLOCK_ITEM) {
+					if (item->stmt)
+						flow = exec(self, item->stmt);
+				} else if (item->decl->kind == AST_VARIABLE_DECL) {
+					variable_decl_t *var = &item->decl->variable;
+					if (var->initial)
+						eval(self, var->initial, &value);
+					else
+						value_zero(self, &value, &var->type, &item->decl->loc);
+					push_var(self, var->name, &value);
+				} else if (item->decl->kind == AST_CONST_DECL) {
+					eval(self, &item->decl->cons.value, &value);
+					push_var(self, item->decl->cons.name, &value);
+				}
+			}
+			pop_vars(self, mark);
+			return flow;
+
+		case AST_IF_STMT:
+			eval(self, stmt->selection.condition, &value);
+			if (value.scalar.i)
+				return stmt->selection.stmt ? exec(self, stmt->selection.stmt) : FLOW_NEXT;
+			return stmt->selection.else_stmt ? exec(self, stmt->selection.else_stmt) : FLOW_NEXT;
+
+		case AST_SWITCH_STMT:
+			eval(self, stmt->selection.condition, &value);
+			return exec_switch(self, stmt, value.scalar.i);
+
+		case AST_FOR_STMT:
+			if (stmt->iteration.initial) {
+				eval(self, stmt->iteration.initial, &value);
+				value_dispose(&value);
+			}
+			for (;;) {
+				step(self);
+				if (stmt->iteration.condition) {
+					eval(self, stmt->iteration.condition, &value);
+					if (!value.scalar.i)
+						break;
+				}
+				flow = stmt->iteration.stmt ? exec(self, stmt->iteration.stmt) : FLOW_NEXT;
+				if (flow == FLOW_BREAK)
+					break;
+				if (flow == FLOW_RETURN)
+					return flow;
+				if (stmt->iteration.step) {
+					eval(self, stmt->iteration.step, &value);
+					value_dispose(&value);
+				}
+			}
+			return FLOW_NEXT;
+
+		case AST_CASE_STMT:
+		case AST_DEFAULT_STMT:
+			return exec(self, stmt->label.stmt);
+
+		case AST_UNCHECKED_STMT:
+			return exec(self, stmt->body);
+
+		case AST_BREAK_STMT:
+			return FLOW_BREAK;
+
+		case AST_CONTINUE_STMT:
+			return FLOW_CONTINUE;
+
+		case AST_RETURN_STMT:
+			if (!stmt->expr)
+				derror(&stmt->loc, "const functions must return a value\n");
+			value_dispose(&self->result);
+			eval(self, stmt->expr, &self->result);
+			return FLOW_RETURN;
+
+		default:
+			derror(&stmt->loc, "statement cannot be executed at compile time\n");
+			return FLOW_NEXT;
+	}
+}
+
+
+/*
+ * Evaluates a call to a const function at compile time and returns the
+ * resulting constant.
+ */
+LLVMValueRef
+codegen_interp_call(codegen_context_t *context, expr_t *expr) {
+	assert(expr->kind == AST_CALL_EXPR);
+	interp_t interp;
+	bzero(&interp, sizeof interp);
+	interp.context = context;
+	interp.loc = expr->loc;
+	array_init(&interp.vars, sizeof(interp_var_t*));
+	array_init(&interp.globals, sizeof(interp_var_t*));
+
+	interp_value_t value;
+	call(&interp, expr, &value);
+	LLVMValueRef result = value_to_llvm(&interp, &value, &expr->type, &expr->loc);
+	value_dispose(&value);
+
+	unsigned i;
+	for (i = 0; i < interp.globals.size; ++i) {
+		interp_var_t *var = *(interp_var_t**)array_get(&interp.globals, i);
+		value_dispose(&var->value);
+		free(var);
+	}
+	array_dispose(&interp.globals);
+	array_dispose(&interp.vars);
+	return result;
+}
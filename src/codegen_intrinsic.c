@@ -0,0 +1,240 @@
+#include "codegen_internal.h"
+#include "llvm_intrinsics.h"
+
+/*
+ * The intrinsic() builtin, which lowers to LLVM's intrinsic functions:
+ *
+ *     intrinsic(ctpop|cttz|ctlz|bswap, x)        bit counts and byte swap of x
+ *     intrinsic(fshl|fshr, a, b, n)              funnel shift of a:b by n
+ *     intrinsic(rotl|rotr, x, n)                 rotate x by n
+ *     intrinsic(prefetch, p [, rw, locality])    rw is 0 or 1, locality 0 to 3
+ *     intrinsic(expect, x, v)                    evaluates to x, likely v
+ *     intrinsic(likely|unlikely, cond)           evaluates to cond
+ *     intrinsic(assume, cond)
+ *     intrinsic(add_overflow|sub_overflow|mul_overflow, a, b, p)
+ *
+ * The bit operations accept integers and vectors of integers and evaluate to
+ * the type of their first operand. The overflow-checked operations store the
+ * wrapped result to *p and evaluate to whether it overflowed. Bit operations
+ * and hints on scalars are folded at compile time if their operands are
+ * known, including within const functions (see codegen_const_intrinsic).
+ */
+
+
+/*
+ * Returns the integer type of an operand, which may also be a vector of
+ * integers if \a allow_vector is set.
+ */
+static type_t *
+require_integer(codegen_context_t *context, unsigned op, expr_t *arg, int allow_vector) {
+	type_t *t = resolve_type_name(context, &arg->type);
+	if (allow_vector && t->pointer == 0 && t->kind == AST_VECTOR_TYPE)
+		t = resolve_type_name(context, t->vector.type);
+	if (t->pointer > 0 || t->kind != AST_INTEGER_TYPE) {
+		char *td = type_describe(&arg->type);
+		derror(&arg->loc, "intrinsic %s requires an integer, got %s\n", intrinsic_ops[op].name, td);
+		free(td);
+	}
+	return t;
+}
+
+static void
+require_bool(codegen_context_t *context, unsigned op, expr_t *arg) {
+	type_t *t = resolve_type_name(context, &arg->type);
+	if (t->pointer > 0 || t->kind != AST_BOOLEAN_TYPE) {
+		char *td = type_describe(&arg->type);
+		derror(&arg->loc, "intrinsic %s requires a bool, got %s\n", intrinsic_ops[op].name, td);
+		free(td);
+	}
+}
+
+/*
+ * Prepares the arguments following the first one, which must be of the same
+ * type as the first.
+ */
+static void
+prepare_same_type(codegen_t *self, codegen_context_t *context, unsigned op, expr_t *args, unsigned num_args) {
+	unsigned i;
+	for (i = 1; i < num_args; ++i) {
+		prepare_expr(self, context, args+i, &args[0].type);
+		if (!type_equal(&args[i].type, &args[0].type)) {
+			char *t1 = type_describe(&args[0].type);
+			char *t2 = type_describe(&args[i].type);
+			derror(&args[i].loc, "intrinsic %s on %s requires an operand of the same type, got %s\n", intrinsic_ops[op].name, t1, t2);
+			free(t1);
+			free(t2);
+		}
+	}
+}
+
+
+PREPARE_EXPR(intrinsic_builtin_expr) {
+	unsigned op = expr->intrinsic.op;
+	expr_t *args = expr->intrinsic.args;
+	type_t bool_type = { .kind = AST_BOOLEAN_TYPE };
+	type_t index_type = { .kind = AST_INTEGER_TYPE, .width = 32 };
+	type_t *t;
+	unsigned i;
+
+	bzero(&expr->type, sizeof expr->type);
+	switch (op) {
+		case AST_INTRINSIC_CTPOP:
+		case AST_INTRINSIC_CTTZ:
+		case AST_INTRINSIC_CTLZ:
+		case AST_INTRINSIC_BSWAP:
+		case AST_INTRINSIC_FSHL:
+		case AST_INTRINSIC_FSHR:
+		case AST_INTRINSIC_ROTL:
+		case AST_INTRINSIC_ROTR:
+			prepare_expr(self, context, args, type_hint);
+			t = require_integer(context, op, args, 1);
+			if (op == AST_INTRINSIC_BSWAP && t->width % 16 != 0)
+				derror(&args[0].loc, "intrinsic bswap requires an integer of a multiple of 16 bits, got %u bits\n", t->width);
+			prepare_same_type(self, context, op, args, expr->intrinsic.num_args);
+			type_copy(&expr->type, &args[0].type);
+			break;
+
+		case AST_INTRINSIC_PREFETCH:
+			prepare_expr(self, context, args, 0);
+			t = resolve_type_name(context, &args[0].type);
+			if (t->pointer == 0 || t->kind == AST_FUNC_TYPE) {
+				char *td = type_describe(&args[0].type);
+				derror(&args[0].loc, "intrinsic prefetch requires a pointer, got %s\n", td);
+				free(td);
+			}
+			for (i = 1; i < expr->intrinsic.num_args; ++i) {
+				static const int limits[] = { 0, 1, 3 };
+				prepare_expr(self, context, args+i, &index_type);
+				if (!args[i].constant.known || args[i].type.kind != AST_INTEGER_TYPE ||
+				    args[i].constant.i < 0 || args[i].constant.i > limits[i])
+					derror(&args[i].loc, "argument %u of intrinsic prefetch must be an integer constant from 0 to %d\n", i+1, limits[i]);
+			}
+			expr->type.kind = AST_VOID_TYPE;
+			break;
+
+		case AST_INTRINSIC_EXPECT:
+			prepare_expr(self, context, args, type_hint);
+			t = resolve_type_name(context, &args[0].type);
+			if (t->kind != AST_BOOLEAN_TYPE)
+				require_integer(context, op, args, 0);
+			prepare_same_type(self, context, op, args, 2);
+			if (!args[1].constant.known)
+				derror(&args[1].loc, "expected value of intrinsic expect must be a constant\n");
+			type_copy(&expr->type, &args[0].type);
+			break;
+
+		case AST_INTRINSIC_LIKELY:
+		case AST_INTRINSIC_UNLIKELY:
+		case AST_INTRINSIC_ASSUME:
+			prepare_expr(self, context, args, &bool_type);
+			require_bool(context, op, args);
+			expr->type.kind = op == AST_INTRINSIC_ASSUME ? AST_VOID_TYPE : AST_BOOLEAN_TYPE;
+			break;
+
+		case AST_INTRINSIC_ADD_OVERFLOW:
+		case AST_INTRINSIC_SUB_OVERFLOW:
+		case AST_INTRINSIC_MUL_OVERFLOW: {
+			prepare_expr(self, context, args, type_hint);
+			require_integer(context, op, args, 0);
+			prepare_same_type(self, context, op, args, 2);
+			type_t result_type;
+			type_copy(&result_type, &args[0].type);
+			++result_type.pointer;
+			prepare_expr(self, context, args+2, &result_type);
+			if (!type_equal(&args[2].type, &result_type)) {
+				char *t1 = type_describe(&result_type);
+				char *t2 = type_describe(&args[2].type);
+				derror(&args[2].loc, "intrinsic %s stores its result through %s, got %s\n", intrinsic_ops[op].name, t1, t2);
+				free(t1);
+				free(t2);
+			}
+			type_dispose(&result_type);
+			expr->type.kind = AST_BOOLEAN_TYPE;
+			break;
+		}
+
+		default:
+			die("unexpected intrinsic %d", op);
+	}
+}
+
+
+static LLVMValueRef
+build_call(codegen_t *self, LLVMIntrinsicID id, LLVMTypeRef type, LLVMValueRef *args, unsigned num_args) {
+	LLVMValueRef func = LLVMGetIntrinsicByID(self->module, id, &type, type ? 1 : 0);
+	return LLVMBuildCall(self->builder, func, args, num_args, "");
+}
+
+CODEGEN_EXPR(intrinsic_builtin_expr) {
+	assert(!lvalue && "result of intrinsic is not a valid lvalue");
+	unsigned op = expr->intrinsic.op;
+	expr_t *args = expr->intrinsic.args;
+	LLVMValueRef values[3];
+	unsigned i;
+	for (i = 0; i < expr->intrinsic.num_args; ++i)
+		values[i] = codegen_expr(self, context, args+i, 0, 0);
+	LLVMTypeRef type = LLVMTypeOf(values[0]);
+	LLVMTypeRef int32 = LLVMInt32Type();
+	LLVMValueRef zero_poison = LLVMConstNull(LLVMInt1Type());
+
+	switch (op) {
+		case AST_INTRINSIC_CTPOP:
+			return build_call(self, LLVMIntrinsicIDCtpop, type, values, 1);
+		case AST_INTRINSIC_CTTZ:
+			return build_call(self, LLVMIntrinsicIDCttz, type, (LLVMValueRef[]){ values[0], zero_poison }, 2);
+		case AST_INTRINSIC_CTLZ:
+			return build_call(self, LLVMIntrinsicIDCtlz, type, (LLVMValueRef[]){ values[0], zero_poison }, 2);
+		case AST_INTRINSIC_BSWAP:
+			return build_call(self, LLVMIntrinsicIDBswap, type, values, 1);
+		case AST_INTRINSIC_FSHL:
+			return build_call(self, LLVMIntrinsicIDFshl, type, values, 3);
+		case AST_INTRINSIC_FSHR:
+			return build_call(self, LLVMIntrinsicIDFshr, type, values, 3);
+
+		// A rotate is a funnel shift of a value with itself.
+		case AST_INTRINSIC_ROTL:
+			return build_call(self, LLVMIntrinsicIDFshl, type, (LLVMValueRef[]){ values[0], values[0], values[1] }, 3);
+		case AST_INTRINSIC_ROTR:
+			return build_call(self, LLVMIntrinsicIDFshr, type, (LLVMValueRef[]){ values[0], values[0], values[1] }, 3);
+
+		case AST_INTRINSIC_PREFETCH: {
+			// Prefetches for reading with maximum locality into the data
+			// cache unless specified otherwise.
+			LLVMTypeRef int8ptr = LLVMPointerType(LLVMInt8Type(), 0);
+			LLVMValueRef ops[4] = {
+				LLVMBuildPointerCast(self->builder, values[0], int8ptr, ""),
+				LLVMConstInt(int32, expr->intrinsic.num_args > 1 ? args[1].constant.i : 0, 0),
+				LLVMConstInt(int32, expr->intrinsic.num_args > 2 ? args[2].constant.i : 3, 0),
+				LLVMConstInt(int32, 1, 0),
+			};
+			return build_call(self, LLVMIntrinsicIDPrefetch, int8ptr, ops, 4);
+		}
+
+		case AST_INTRINSIC_EXPECT:
+			return build_call(self, LLVMIntrinsicIDExpect, type, values, 2);
+		case AST_INTRINSIC_LIKELY:
+		case AST_INTRINSIC_UNLIKELY: {
+			LLVMValueRef expected = LLVMConstInt(type, op == AST_INTRINSIC_LIKELY, 0);
+			return build_call(self, LLVMIntrinsicIDExpect, type, (LLVMValueRef[]){ values[0], expected }, 2);
+		}
+		case AST_INTRINSIC_ASSUME:
+			return build_call(self, LLVMIntrinsicIDAssume, 0, values, 1);
+
+		default:
+			break;
+	}
+
+	type_t *t = resolve_type_name(context, &args[0].type);
+	LLVMIntrinsicID id;
+	switch (op) {
+		case AST_INTRINSIC_ADD_OVERFLOW: id = t->is_unsigned ? LLVMIntrinsicIDUaddWithOverflow : LLVMIntrinsicIDSaddWithOverflow; break;
+		case AST_INTRINSIC_SUB_OVERFLOW: id = t->is_unsigned ? LLVMIntrinsicIDUsubWithOverflow : LLVMIntrinsicIDSsubWithOverflow; break;
+		case AST_INTRINSIC_MUL_OVERFLOW: id = t->is_unsigned ? LLVMIntrinsicIDUmulWithOverflow : LLVMIntrinsicIDSmulWithOverflow; break;
+		default:
+			die("unexpected intrinsic %d", op);
+			return 0;
+	}
+	LLVMValueRef result = build_call(self, id, type, values, 2);
+	codegen_store(self, context, LLVMBuildExtractValue(self->builder, result, 0, ""), values[2], &args[0].type, 0);
+	return LLVMBuildExtractValue(self->builder, result, 1, "overflow");
+}
@@ -0,0 +1,21 @@
+#include "codegen_internal.h"
+
+
+PREPARE_EXPR(label_addr_expr) {
+	expr->type.kind = AST_INTEGER_TYPE;
+	expr->type.width = 8;
+	expr->type.pointer = 1;
+}
+
+
+/*
+ * Returns the address of a label in the current function, as in `&&name`. The
+ * only thing that can be done with the address is to jump to it with an
+ * indirect goto in the same function.
+ */
+CODEGEN_EXPR(label_addr_expr) {
+	assert(!lvalue && "label address is not a valid lvalue");
+	codegen_label_t *label = codegen_label(self, expr->ident, &expr->loc);
+	label->address_taken = 1;
+	return LLVMBlockAddress(self->func, label->block);
+}
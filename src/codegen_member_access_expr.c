@@ -36,16 +36,216 @@ PREPARE_EXPR(member_access_expr) {
 }
 
 
-CODEGEN_EXPR(member_access_expr) {
-	unsigned i;
+/*
+ * Returns the struct a member access expression refers to a member of, and
+ * the index of that member. Returns null for interface members.
+ */
+static type_t *
+find_member(codegen_context_t *context, expr_t *expr, unsigned *index) {
 	type_t *st = resolve_type_name(context, &expr->member_access.target->type);
-	type_t *stderef = st;
-	type_t tmp;
-	if (stderef->pointer > 0) {
-		tmp = *stderef;
+	if (st->kind == AST_INTERFACE_TYPE)
+		return 0;
+	if (st->pointer > 0) {
+		type_t tmp = *st;
 		--tmp.pointer;
-		stderef = resolve_type_name(context, &tmp);
+		st = resolve_type_name(context, &tmp);
+	}
+	assert(st->kind == AST_STRUCT_TYPE && "cannot access member of non-struct");
+	unsigned i;
+	for (i = 0; i < st->strct.num_members; ++i)
+		if (strcmp(expr->member_access.name, st->strct.members[i].name) == 0)
+			break;
+	assert(i < st->strct.num_members && "struct has no such member");
+	*index = i;
+	return st;
+}
+
+/*
+ * Returns a pointer to the LLVM field that holds member \a index of the
+ * struct a member access expression refers to.
+ */
+static LLVMValueRef
+field_ptr(codegen_t *self, codegen_context_t *context, expr_t *expr, type_t *st, unsigned index) {
+	type_t *target_type = resolve_type_name(context, &expr->member_access.target->type);
+	if (target_type->pointer > 1)
+		derror(&expr->loc, "cannot access member across multiple indirection\n");
+	LLVMValueRef target = codegen_expr(self, context, expr->member_access.target, target_type->pointer == 0, 0);
+	if (!target)
+		derror(&expr->loc, "cannot member-access target\n");
+	return LLVMBuildStructGEP(self->builder, target, codegen_struct_field(context, st, index), "");
+}
+
+/*
+ * Returns the alignment in bytes of the member a member access expression
+ * refers to, as implied by the alignment of the struct and the offset of the
+ * member within it. Members of packed structs may be aligned less than their
+ * type requires, members of structs with alignas more. Elements of array and
+ * vector members are aligned as the member, up to their size. Returns 0 for
+ * any other expression, which is aligned as its type.
+ */
+unsigned
+codegen_member_align(codegen_context_t *context, expr_t *expr) {
+	LLVMTargetDataRef layout = codegen_target_data();
+	unsigned align = 0;
+	if (expr->kind == AST_INDEX_ACCESS_EXPR) {
+		type_t *at = resolve_type_name(context, &expr->index_access.target->type);
+		if (at->pointer > 0 || (at->kind != AST_ARRAY_TYPE && at->kind != AST_VECTOR_TYPE))
+			return 0;
+		align = codegen_member_align(context, expr->index_access.target);
+		if (!align)
+			return 0;
+		type_t *et = at->kind == AST_ARRAY_TYPE ? at->array.type : at->vector.type;
+		unsigned long long size = LLVMABISizeOfType(layout, codegen_type(context, et));
+		while (size % align)
+			align /= 2;
+		return align;
+	}
+	if (expr->kind != AST_MEMBER_ACCESS_EXPR)
+		return 0;
+	unsigned i;
+	type_t *st = find_member(context, expr, &i);
+	if (!st)
+		return 0;
+	LLVMTypeRef type = codegen_type(context, st);
+
+	// A struct that is itself a member is aligned as that member, any other
+	// as its type.
+	if (resolve_type_name(context, &expr->member_access.target->type)->pointer == 0)
+		align = codegen_member_align(context, expr->member_access.target);
+	if (!align) {
+		align = LLVMABIAlignmentOfType(layout, type);
+		if (codegen_type_align(context, st) > align)
+			align = codegen_type_align(context, st);
+	}
+	unsigned long long offset = LLVMOffsetOfElement(layout, type, codegen_struct_field(context, st, i));
+	while (offset % align)
+		align /= 2;
+	return align;
+}
+
+
+/*
+ * Locates the bitfield a member access expression refers to. Returns 0
+ * without generating any code if the expression does not access a bitfield.
+ */
+int
+codegen_bitfield(codegen_t *self, codegen_context_t *context, expr_t *expr, codegen_bitfield_t *bf) {
+	if (expr->kind != AST_MEMBER_ACCESS_EXPR)
+		return 0;
+	unsigned i;
+	type_t *st = find_member(context, expr, &i);
+	if (!st || st->strct.members[i].bits == 0)
+		return 0;
+	type_t *mt = resolve_type_name(context, st->strct.members[i].type);
+	bf->ptr = field_ptr(self, context, expr, st, i);
+	bf->shift = codegen_struct_shift(context, st, i);
+	bf->bits = st->strct.members[i].bits;
+	bf->is_signed = !mt->is_unsigned;
+	bf->align = codegen_member_align(context, expr);
+	return 1;
+}
+
+/*
+ * Extracts the value of a bitfield from a single load of the field that
+ * holds it. Signed bitfields are sign-extended.
+ */
+LLVMValueRef
+codegen_bitfield_load(codegen_t *self, codegen_bitfield_t *bf) {
+	LLVMValueRef word = LLVMBuildLoad(self->builder, bf->ptr, "");
+	LLVMSetAlignment(word, bf->align);
+	LLVMTypeRef type = LLVMTypeOf(word);
+	unsigned width = LLVMGetIntTypeWidth(type);
+	if (bf->is_signed) {
+		LLVMValueRef high = LLVMBuildShl(self->builder, word, LLVMConstInt(type, width - bf->shift - bf->bits, 0), "");
+		return LLVMBuildAShr(self->builder, high, LLVMConstInt(type, width - bf->bits, 0), "");
 	}
+	LLVMValueRef value = LLVMBuildLShr(self->builder, word, LLVMConstInt(type, bf->shift, 0), "");
+	if (bf->bits == width)
+		return value;
+	return LLVMBuildAnd(self->builder, value, LLVMConstInt(type, (1ULL << bf->bits) - 1, 0), "");
+}
+
+
+/*
+ * Returns whether two pointers computed in the same block refer to the same
+ * address. Loads from a local whose address is not taken are considered
+ * equal, since the caller ensures there are no stores in between.
+ */
+static int
+same_address(LLVMValueRef a, LLVMValueRef b) {
+	if (a == b)
+		return 1;
+	if (LLVMIsAGetElementPtrInst(a) && LLVMIsAGetElementPtrInst(b)) {
+		unsigned i, n = LLVMGetNumOperands(a);
+		if (LLVMGetNumOperands(b) != n)
+			return 0;
+		for (i = 0; i < n; ++i)
+			if (!same_address(LLVMGetOperand(a, i), LLVMGetOperand(b, i)))
+				return 0;
+		return 1;
+	}
+	if (LLVMIsALoadInst(a) && LLVMIsALoadInst(b))
+		return LLVMGetOperand(a, 0) == LLVMGetOperand(b, 0) && LLVMIsAAllocaInst(LLVMGetOperand(a, 0));
+	return 0;
+}
+
+/*
+ * Returns the store to \a ptr that immediately precedes the current position
+ * of the builder. Only instructions that neither write memory nor read the
+ * stored value may come in between, which are computations and loads of
+ * pointers held in locals.
+ */
+static LLVMValueRef
+preceding_store(codegen_t *self, LLVMValueRef ptr) {
+	LLVMValueRef inst;
+	for (inst = LLVMGetLastInstruction(LLVMGetInsertBlock(self->builder)); inst; inst = LLVMGetPreviousInstruction(inst)) {
+		if (LLVMIsAStoreInst(inst))
+			return same_address(LLVMGetOperand(inst, 1), ptr) && !LLVMGetVolatile(inst) ? inst : 0;
+		if (LLVMIsALoadInst(inst)) {
+			LLVMValueRef slot = LLVMGetOperand(inst, 0);
+			if (!LLVMIsAAllocaInst(slot) || LLVMGetTypeKind(LLVMGetAllocatedType(slot)) != LLVMPointerTypeKind)
+				return 0;
+		} else if (!LLVMIsAGetElementPtrInst(inst) && !LLVMIsACastInst(inst) &&
+		           !LLVMIsABinaryOperator(inst) && !LLVMIsACmpInst(inst)) {
+			return 0;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Stores a value into a bitfield, leaving the other bits of the field that
+ * holds it untouched. If the field was just written to, as when adjacent
+ * bitfields are assigned one after another, the earlier store is folded into
+ * this one such that the field is only loaded and stored once.
+ */
+void
+codegen_bitfield_store(codegen_t *self, codegen_bitfield_t *bf, LLVMValueRef value) {
+	LLVMValueRef word;
+	LLVMValueRef prev = preceding_store(self, bf->ptr);
+	if (prev) {
+		word = LLVMGetOperand(prev, 0);
+		LLVMInstructionEraseFromParent(prev);
+	} else {
+		word = LLVMBuildLoad(self->builder, bf->ptr, "");
+		LLVMSetAlignment(word, bf->align);
+	}
+	LLVMTypeRef type = LLVMTypeOf(word);
+	unsigned width = LLVMGetIntTypeWidth(type);
+	unsigned long long ones = bf->bits == 64 ? ~0ULL : (1ULL << bf->bits) - 1;
+	LLVMValueRef mask = LLVMConstInt(type, ones << bf->shift, 0);
+	if (bf->bits < width)
+		value = LLVMBuildAnd(self->builder, value, LLVMConstInt(type, ones, 0), "");
+	value = LLVMBuildShl(self->builder, value, LLVMConstInt(type, bf->shift, 0), "");
+	word = LLVMBuildAnd(self->builder, word, LLVMConstNot(mask), "");
+	word = LLVMBuildOr(self->builder, word, value, "");
+	LLVMSetAlignment(LLVMBuildStore(self->builder, word, bf->ptr), bf->align);
+}
+
+
+CODEGEN_EXPR(member_access_expr) {
+	unsigned i;
+	type_t *st = resolve_type_name(context, &expr->member_access.target->type);
 
 	LLVMValueRef ptr;
 	if (st->kind == AST_INTERFACE_TYPE) {
@@ -66,25 +266,15 @@ CODEGEN_EXPR(member_access_expr) {
 		LLVMValueRef ptr_bytes = LLVMBuildInBoundsGEP(self->builder, object_ptr, &member_offset_int, 1, "ptr_bytes");
 		ptr = LLVMBuildPointerCast(self->builder, ptr_bytes, LLVMTypeOf(member_offset), "");
 	} else {
-		if (st->pointer > 1)
-			derror(&expr->loc, "cannot access member across multiple indirection\n");
-		LLVMValueRef target = codegen_expr(self, context, expr->member_access.target, st->pointer == 0, 0);
-		if (!target)
-			derror(&expr->loc, "cannot member-access target\n");
-		// LLVMValueRef struct_ptr = st->pointer == 1 ? LLVMBuildLoad(self->builder, target, "") : target;
-		LLVMValueRef struct_ptr = target;
-		assert(stderef->kind == AST_STRUCT_TYPE && "cannot access member of non-struct");
-		for (i = 0; i < stderef->strct.num_members; ++i)
-			if (strcmp(expr->member_access.name, stderef->strct.members[i].name) == 0)
-				break;
-		assert(i < stderef->strct.num_members && "struct has no such member");
-
-		// char *target_ts = LLVMPrintTypeToString(LLVMTypeOf(target));
-		// printf("  in LLVM accessing %s of %s\n", expr->member_access.name, target_ts);
-		// LLVMDisposeMessage(target_ts);
-		// type_copy(&expr->type, st->strct.members[i].type);
-		ptr = LLVMBuildStructGEP(self->builder, struct_ptr, i, "");
+		codegen_bitfield_t bf;
+		if (codegen_bitfield(self, context, expr, &bf)) {
+			if (lvalue)
+				derror(&expr->loc, "cannot take the address of bitfield '%s'\n", expr->member_access.name);
+			return codegen_bitfield_load(self, &bf);
+		}
+		type_t *stderef = find_member(context, expr, &i);
+		ptr = field_ptr(self, context, expr, stderef, i);
 	}
 
-	return lvalue ? ptr : LLVMBuildLoad(self->builder, ptr, "");
+	return lvalue ? ptr : codegen_load(self, context, ptr, &expr->type, codegen_member_align(context, expr));
 }
@@ -12,6 +12,19 @@ CODEGEN_EXPR(number_literal_expr) {
 	assert(!lvalue && "number literal is not a valid lvalue");
 	if (expr->type.kind == AST_NO_TYPE)
 		derror(&expr->loc, "type of literal '%s' cannot be inferred from context, use a cast\n", expr->number_literal);
+	type_t *vector = resolve_type_name(context, &expr->type);
+	if (vector->pointer == 0 && vector->kind == AST_VECTOR_TYPE) {
+		// Literals used as vectors are broadcast to all lanes.
+		expr_t lane = *expr;
+		type_copy(&lane.type, vector->vector.type);
+		LLVMValueRef value = codegen_number_literal_expr(self, context, &lane, 0);
+		type_dispose(&lane.type);
+		unsigned i, n = vector->vector.length;
+		LLVMValueRef lanes[n];
+		for (i = 0; i < n; ++i)
+			lanes[i] = value;
+		return LLVMConstVector(lanes, n);
+	}
 	if (expr->type.kind == AST_INTEGER_TYPE) {
 		return LLVMConstIntOfString(codegen_type(context, &expr->type), expr->number_literal.literal, expr->number_literal.radix);
 	} else if (expr->type.kind == AST_FLOAT_TYPE) {
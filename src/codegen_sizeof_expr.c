@@ -17,7 +17,9 @@ CODEGEN_EXPR(sizeof_expr) {
 	LLVMValueRef v;
 	switch (expr->sizeof_op.mode) {
 		case AST_EXPR_SIZEOF:
-			v = LLVMSizeOf(LLVMTypeOf(codegen_expr(self, context, expr->sizeof_op.expr, 0, 0)));
+			if (expr->sizeof_op.expr->type.kind == AST_NO_TYPE)
+				derror(&expr->sizeof_op.expr->loc, "type of sizeof operand cannot be inferred, use a cast\n");
+			v = LLVMSizeOf(codegen_type(context, &expr->sizeof_op.expr->type));
 			break;
 		case AST_TYPE_SIZEOF:
 			v = LLVMSizeOf(codegen_type(context, &expr->sizeof_op.type));
@@ -26,5 +28,5 @@ CODEGEN_EXPR(sizeof_expr) {
 			fprintf(stderr, "%s.%d: codegen for sizeof mode %d not implemented\n", __FILE__, __LINE__, expr->sizeof_op.mode);
 			abort();
 	}
-	return LLVMBuildIntCast(self->builder, v, codegen_type(context, &expr->type), "");
+	return LLVMConstIntCast(v, codegen_type(context, &expr->type), 0);
 }
@@ -93,23 +93,168 @@ CODEGEN_TYPE(named){
 	return codegen_type(context, sym->type);
 }
 
-CODEGEN_TYPE(struct){
-	LLVMTypeRef members[type->strct.num_members];
+/*
+ * Assigns the members of a struct to the LLVM fields that hold them. Runs of
+ * adjacent bitfields of the same width share a field as long as their bits
+ * fit into it. Returns the number of fields. If non-null, \a fields receives
+ * the field of every member and \a shifts the bit offset of bitfields within
+ * their field.
+ */
+static unsigned
+assign_fields(codegen_context_t *context, type_t *type, unsigned *fields, unsigned *shifts) {
+	unsigned i, num_fields = 0, used = 0, width = 0;
+	for (i = 0; i < type->strct.num_members; ++i) {
+		struct_member_t *m = type->strct.members + i;
+		unsigned w = 0;
+		if (m->bits) {
+			type_t *t = resolve_type_name(context, m->type);
+			if (t->pointer > 0 || t->kind != AST_INTEGER_TYPE)
+				derror(&m->loc, "bitfield '%s' must be of integer type\n", m->name);
+			if (t->byte_order != AST_NATIVE_ORDER)
+				derror(&m->loc, "bitfield '%s' cannot have an explicit byte order\n", m->name);
+			if (m->bits > t->width)
+				derror(&m->loc, "bitfield '%s' is %u bits wide, but its type only holds %u\n", m->name, m->bits, t->width);
+			w = t->width;
+		}
+		if (m->bits == 0 || m->align || w != width || used + m->bits > width) {
+			++num_fields;
+			used = 0;
+			width = w;
+		}
+		if (fields)
+			fields[i] = num_fields - 1;
+		if (shifts)
+			shifts[i] = used;
+		used += m->bits;
+	}
+	return num_fields;
+}
+
+/*
+ * Returns whether a struct requires an alignment beyond the natural one of
+ * its members. Such structs are laid out explicitly, with a padding field in
+ * front of every field and one at the end.
+ */
+static int
+has_explicit_layout(codegen_context_t *context, type_t *type) {
+	if (type->strct.align)
+		return 1;
 	unsigned i;
 	for (i = 0; i < type->strct.num_members; ++i)
-		members[i] = codegen_type(context, type->strct.members[i].type);
-	return LLVMStructType(members, type->strct.num_members, 0);
+		if (type->strct.members[i].align || codegen_type_align(context, type->strct.members[i].type))
+			return 1;
+	return 0;
+}
+
+/*
+ * Returns the index of the LLVM field that holds member \a index of a struct.
+ */
+unsigned
+codegen_struct_field(codegen_context_t *context, type_t *type, unsigned index) {
+	unsigned fields[type->strct.num_members];
+	assign_fields(context, type, fields, 0);
+	return has_explicit_layout(context, type) ? 2*fields[index]+1 : fields[index];
+}
+
+/*
+ * Returns the offset in bits of bitfield member \a index of a struct within
+ * the LLVM field that holds it.
+ */
+unsigned
+codegen_struct_shift(codegen_context_t *context, type_t *type, unsigned index) {
+	unsigned shifts[type->strct.num_members];
+	assign_fields(context, type, 0, shifts);
+	return shifts[index];
+}
+
+/*
+ * Returns the alignment in bytes that values of a type require beyond what
+ * LLVM derives from their type, or 0 if the natural alignment suffices.
+ * Allocas, globals, and heap allocations of such types are aligned
+ * explicitly.
+ */
+unsigned
+codegen_type_align(codegen_context_t *context, type_t *type) {
+	type_t *t = resolve_type_name(context, type);
+	if (t->pointer > 0)
+		return 0;
+	if (t->kind == AST_ARRAY_TYPE)
+		return codegen_type_align(context, t->array.type);
+	if (t->kind != AST_STRUCT_TYPE)
+		return 0;
+	unsigned i, align = t->strct.align;
+	for (i = 0; i < t->strct.num_members; ++i) {
+		unsigned a = t->strct.members[i].align;
+		if (!t->strct.packed) {
+			unsigned ta = codegen_type_align(context, t->strct.members[i].type);
+			if (ta > a)
+				a = ta;
+		}
+		if (a > align)
+			align = a;
+	}
+	return align;
+}
+
+CODEGEN_TYPE(struct){
+	unsigned i, n = type->strct.num_members;
+	unsigned fields[n];
+	unsigned num_fields = assign_fields(context, type, fields, 0);
+
+	// Each field is of the type of the first member it holds.
+	struct_member_t *firsts[num_fields];
+	LLVMTypeRef members[num_fields];
+	for (i = 0; i < n; ++i) {
+		if (i > 0 && fields[i] == fields[i-1])
+			continue;
+		firsts[fields[i]] = type->strct.members + i;
+		members[fields[i]] = codegen_type(context, type->strct.members[i].type);
+	}
+	if (!has_explicit_layout(context, type))
+		return LLVMStructType(members, num_fields, type->strct.packed);
+
+	// Pad each field to its alignment and the struct to a multiple of its
+	// own alignment. The padding keeps every field at an offset LLVM would
+	// choose anyway, such that the struct need not be packed.
+	LLVMTargetDataRef layout = codegen_target_data();
+	LLVMTypeRef padded[2*num_fields+1];
+	unsigned long long offset = 0;
+	unsigned align = 1;
+	for (i = 0; i < num_fields; ++i) {
+		unsigned a = firsts[i]->align;
+		if (!type->strct.packed) {
+			unsigned natural = LLVMABIAlignmentOfType(layout, members[i]);
+			unsigned ta = codegen_type_align(context, firsts[i]->type);
+			if (natural > a)
+				a = natural;
+			if (ta > a)
+				a = ta;
+		}
+		if (a < 1)
+			a = 1;
+		if (a > align)
+			align = a;
+		unsigned pad = (a - offset % a) % a;
+		padded[2*i] = LLVMArrayType(LLVMInt8Type(), pad);
+		padded[2*i+1] = members[i];
+		offset += pad + LLVMABISizeOfType(layout, members[i]);
+	}
+	if (type->strct.align > align)
+		align = type->strct.align;
+	padded[2*num_fields] = LLVMArrayType(LLVMInt8Type(), (align - offset % align) % align);
+	return LLVMStructType(padded, 2*num_fields+1, type->strct.packed);
 }
 
 CODEGEN_TYPE(slice){
 	// underlying struct of a slice
 	LLVMTypeRef arrtype = LLVMPointerType(codegen_type(context, type->slice.type), 0);
-	LLVMTypeRef members[4];
+	LLVMTypeRef members[5];
 	members[0] = arrtype; // pointer to array
 	members[1] = LLVMIntType(64); 			// length @HARDCODED
 	members[2] = LLVMIntType(64); 			// capacity @HARDCODED
 	members[3] = arrtype; // base
-	return LLVMStructType(members, 4, 0); 	// NOT PACKED
+	members[4] = LLVMInt1Type(); // whether the memory at base may be resized
+	return LLVMStructType(members, 5, 0); 	// NOT PACKED
 }
 
 CODEGEN_TYPE(array){
@@ -117,6 +262,14 @@ CODEGEN_TYPE(array){
 	return LLVMArrayType(element, type->array.length);
 }
 
+CODEGEN_TYPE(vector){
+	type_t *et = resolve_type_name(context, type->vector.type);
+	if (et->pointer == 0 && et->kind == AST_INTEGER_TYPE && et->byte_order != AST_NATIVE_ORDER)
+		derror(&type->vector.loc, "vector elements cannot have an explicit byte order\n");
+	LLVMTypeRef element = codegen_type(context, type->vector.type);
+	return LLVMVectorType(element, type->vector.length);
+}
+
 CODEGEN_TYPE(interface){
 	LLVMTypeRef fields[] = {
 		LLVMPointerType(make_interface_table_type(context, type->interface.members, type->interface.num_members), 0),
@@ -145,6 +298,7 @@ const codegen_type_fn_t codegen_type_fn[AST_NUM_TYPES] = {
 	[AST_STRUCT_TYPE]     		= codegen_type_struct,
 	[AST_SLICE_TYPE]     		= codegen_type_slice,
 	[AST_ARRAY_TYPE]     		= codegen_type_array,
+	[AST_VECTOR_TYPE]     		= codegen_type_vector,
 	[AST_INTERFACE_TYPE]     	= codegen_type_interface,
 
 };
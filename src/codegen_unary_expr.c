@@ -42,9 +42,17 @@ PREPARE_EXPR(unary_expr) {
 
 		case AST_NOT: {
 			type_t bool_type = { .kind = AST_BOOLEAN_TYPE };
-			prepare_expr(self, context, expr->unary_op.target, &bool_type);
-			bzero(&expr->type, sizeof expr->type);
-			expr->type.kind = AST_BOOLEAN_TYPE;
+			type_t *hint = type_hint ? resolve_type_name(context, type_hint) : 0;
+			if (!hint || hint->pointer > 0 || hint->kind != AST_VECTOR_TYPE)
+				hint = &bool_type;
+			prepare_expr(self, context, expr->unary_op.target, hint);
+			type_t *target = resolve_type_name(context, &expr->unary_op.target->type);
+			if (target->pointer == 0 && target->kind == AST_VECTOR_TYPE) {
+				type_copy(&expr->type, &expr->unary_op.target->type);
+			} else {
+				bzero(&expr->type, sizeof expr->type);
+				expr->type.kind = AST_BOOLEAN_TYPE;
+			}
 		} break;
 
 		default:
@@ -54,7 +62,11 @@ PREPARE_EXPR(unary_expr) {
 
 
 CODEGEN_EXPR(unary_expr) {
+	// Vectors are operated on lane by lane.
 	type_t *type = &expr->unary_op.target->type;
+	type_t *resolved = resolve_type_name(context, type);
+	if (resolved->pointer == 0 && resolved->kind == AST_VECTOR_TYPE)
+		type = resolve_type_name(context, resolved->vector.type);
 	switch (expr->unary_op.op) {
 		LLVMValueRef target;
 
@@ -63,7 +75,7 @@ CODEGEN_EXPR(unary_expr) {
 
 		case AST_DEREF:
 			target = codegen_expr(self, context, expr->unary_op.target, 0, 0);
-			return lvalue ? target : LLVMBuildLoad(self->builder, target, "");
+			return lvalue ? target : codegen_load(self, context, target, &expr->type, 0);
 
 		case AST_POSITIVE:
 			return codegen_expr(self, context, expr->unary_op.target, 0, 0);
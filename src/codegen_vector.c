@@ -0,0 +1,161 @@
+#include "codegen_internal.h"
+#include "llvm_intrinsics.h"
+
+/*
+ * Builtins operating on SIMD vectors of type `vec<N,T>`. Element-wise
+ * arithmetic and comparisons are handled by the binary and unary operators,
+ * lanes are accessed by indexing, and a scalar is broadcast to all lanes by
+ * casting it to a vector type.
+ */
+
+
+/*
+ * Returns a vector of `length` lanes that all hold `value`.
+ */
+LLVMValueRef
+codegen_splat(codegen_t *self, LLVMValueRef value, unsigned length) {
+	LLVMTypeRef type = LLVMVectorType(LLVMTypeOf(value), length);
+	LLVMValueRef vector = LLVMBuildInsertElement(self->builder, LLVMGetUndef(type), value, LLVMConstNull(LLVMInt32Type()), "");
+	LLVMValueRef mask = LLVMConstNull(LLVMVectorType(LLVMInt32Type(), length));
+	return LLVMBuildShuffleVector(self->builder, vector, LLVMGetUndef(type), mask, "splat");
+}
+
+
+static type_t *
+require_vector(codegen_context_t *context, expr_t *expr, const char *builtin) {
+	type_t *type = resolve_type_name(context, &expr->type);
+	if (type->pointer > 0 || type->kind != AST_VECTOR_TYPE) {
+		char *td = type_describe(&expr->type);
+		derror(&expr->loc, "%s requires a vector, got %s\n", builtin, td);
+		free(td);
+	}
+	return type;
+}
+
+
+PREPARE_EXPR(shuffle_builtin_expr) {
+	type_t index_type = { .kind = AST_INTEGER_TYPE, .width = 32 };
+	expr_t *args = expr->shuffle.args;
+	if (expr->shuffle.num_args < 2)
+		derror(&expr->loc, "shuffle requires a vector and at least one lane index\n");
+	prepare_expr(self, context, args, 0);
+	type_t *vt = require_vector(context, args, "shuffle");
+
+	// The second argument is either another vector or the first index.
+	unsigned first_index = 1;
+	prepare_expr(self, context, args+1, 0);
+	if (type_equal(&args[1].type, &args[0].type))
+		first_index = 2;
+	if (first_index == expr->shuffle.num_args)
+		derror(&expr->loc, "shuffle requires at least one lane index\n");
+
+	unsigned i, num_lanes = vt->vector.length * first_index;
+	for (i = first_index; i < expr->shuffle.num_args; ++i) {
+		expr_t *index = args+i;
+		prepare_expr(self, context, index, &index_type);
+		if (!index->constant.known || index->type.kind != AST_INTEGER_TYPE)
+			derror(&index->loc, "lane index of shuffle must be an integer constant\n");
+		if (index->constant.i < 0 || index->constant.i >= num_lanes)
+			derror(&index->loc, "lane index %lld of shuffle is out of range, %u lanes available\n", index->constant.i, num_lanes);
+	}
+
+	bzero(&expr->type, sizeof expr->type);
+	expr->type.kind = AST_VECTOR_TYPE;
+	expr->type.vector.length = expr->shuffle.num_args - first_index;
+	expr->type.vector.type = malloc(sizeof(type_t));
+	type_copy(expr->type.vector.type, vt->vector.type);
+}
+
+
+CODEGEN_EXPR(shuffle_builtin_expr) {
+	assert(!lvalue && "result of shuffle is not a valid lvalue");
+	expr_t *args = expr->shuffle.args;
+	unsigned first_index = type_equal(&args[1].type, &args[0].type) ? 2 : 1;
+
+	LLVMValueRef a = codegen_expr(self, context, args, 0, 0);
+	LLVMValueRef b = first_index == 2 ? codegen_expr(self, context, args+1, 0, 0) : LLVMGetUndef(LLVMTypeOf(a));
+
+	unsigned i, n = expr->shuffle.num_args - first_index;
+	LLVMValueRef mask[n];
+	for (i = 0; i < n; ++i)
+		mask[i] = LLVMConstInt(LLVMInt32Type(), args[first_index+i].constant.i, 0);
+	return LLVMBuildShuffleVector(self->builder, a, b, LLVMConstVector(mask, n), "shuffle");
+}
+
+
+static const char *reduce_names[] = {
+	[AST_REDUCE_ADD] = "add",
+	[AST_REDUCE_MUL] = "mul",
+	[AST_REDUCE_AND] = "and",
+	[AST_REDUCE_OR]  = "or",
+	[AST_REDUCE_XOR] = "xor",
+	[AST_REDUCE_MIN] = "min",
+	[AST_REDUCE_MAX] = "max",
+};
+
+PREPARE_EXPR(reduce_builtin_expr) {
+	prepare_expr(self, context, expr->reduce.expr, 0);
+	type_t *vt = require_vector(context, expr->reduce.expr, "reduce");
+	type_t *et = resolve_type_name(context, vt->vector.type);
+
+	// Booleans only support the bitwise reductions, floats only the
+	// arithmetic ones.
+	unsigned op = expr->reduce.op;
+	int bitwise = op == AST_REDUCE_AND || op == AST_REDUCE_OR || op == AST_REDUCE_XOR;
+	if ((et->kind == AST_BOOLEAN_TYPE && !bitwise) || (et->kind == AST_FLOAT_TYPE && bitwise)) {
+		char *td = type_describe(&expr->reduce.expr->type);
+		derror(&expr->loc, "reduction '%s' not available for %s\n", reduce_names[op], td);
+		free(td);
+	}
+	type_copy(&expr->type, vt->vector.type);
+}
+
+
+CODEGEN_EXPR(reduce_builtin_expr) {
+	assert(!lvalue && "result of reduce is not a valid lvalue");
+	LLVMValueRef vector = codegen_expr(self, context, expr->reduce.expr, 0, 0);
+	LLVMTypeRef vector_type = LLVMTypeOf(vector);
+	LLVMTypeRef element_type = LLVMGetElementType(vector_type);
+	type_t *et = resolve_type_name(context, &expr->type);
+
+	LLVMIntrinsicID id;
+	if (et->kind == AST_FLOAT_TYPE) {
+		// Floating point sums and products require a start value and are
+		// evaluated in lane order.
+		LLVMValueRef args[2] = { 0, vector };
+		switch (expr->reduce.op) {
+			case AST_REDUCE_ADD:
+				id = LLVMIntrinsicIDVectorReduceFAdd;
+				args[0] = LLVMConstReal(element_type, -0.0);
+				break;
+			case AST_REDUCE_MUL:
+				id = LLVMIntrinsicIDVectorReduceFMul;
+				args[0] = LLVMConstReal(element_type, 1.0);
+				break;
+			case AST_REDUCE_MIN: id = LLVMIntrinsicIDVectorReduceFMin; break;
+			case AST_REDUCE_MAX: id = LLVMIntrinsicIDVectorReduceFMax; break;
+			default:
+				die("unexpected float reduction %d", expr->reduce.op);
+				return 0;
+		}
+		LLVMValueRef func = LLVMGetIntrinsicByID(self->module, id, &vector_type, 1);
+		return args[0] ?
+			LLVMBuildCall(self->builder, func, args, 2, "") :
+			LLVMBuildCall(self->builder, func, args+1, 1, "");
+	}
+
+	switch (expr->reduce.op) {
+		case AST_REDUCE_ADD: id = LLVMIntrinsicIDVectorReduceAdd; break;
+		case AST_REDUCE_MUL: id = LLVMIntrinsicIDVectorReduceMul; break;
+		case AST_REDUCE_AND: id = LLVMIntrinsicIDVectorReduceAnd; break;
+		case AST_REDUCE_OR:  id = LLVMIntrinsicIDVectorReduceOr;  break;
+		case AST_REDUCE_XOR: id = LLVMIntrinsicIDVectorReduceXor; break;
+		case AST_REDUCE_MIN: id = et->is_unsigned ? LLVMIntrinsicIDVectorReduceUMin : LLVMIntrinsicIDVectorReduceSMin; break;
+		case AST_REDUCE_MAX: id = et->is_unsigned ? LLVMIntrinsicIDVectorReduceUMax : LLVMIntrinsicIDVectorReduceSMax; break;
+		default:
+			die("unexpected reduction %d", expr->reduce.op);
+			return 0;
+	}
+	LLVMValueRef func = LLVMGetIntrinsicByID(self->module, id, &vector_type, 1);
+	return LLVMBuildCall(self->builder, func, &vector, 1, "");
+}
@@ -11,6 +11,19 @@
 #define REDUCER(name) void reduce_##name(token_t *out, const token_t *in, int tag)
 
 
+/// Parses the number literal of an `alignas(N)` attribute, which must be a
+/// power of two.
+static unsigned
+parse_alignment(const token_t *tkn) {
+	unsigned align = atoi(tkn->first);
+	if (align == 0 || (align & (align - 1)) != 0) {
+		loc_t loc = tkn->loc;
+		derror(&loc, "alignment must be a power of two\n");
+	}
+	return align;
+}
+
+
 // --- primary_expr ------------------------------------------------------------
 
 REDUCER(primary_expr_ident) {
@@ -271,6 +284,15 @@ REDUCER(unary_expr_op) {
 	out->ptr = e;
 }
 
+REDUCER(unary_expr_label_addr) {
+	expr_t *e = malloc(sizeof(expr_t));
+	bzero(e, sizeof(*e));
+	e->kind = AST_LABEL_ADDR_EXPR;
+	e->loc = in[0].loc;
+	e->ident = strndup(in[1].first, in[1].last-in[1].first);
+	out->ptr = e;
+}
+
 REDUCER(unary_op) {
 	switch (in->id) {
 		case TKN_BITWISE_AND: out->tag = AST_ADDRESS; break;
@@ -310,12 +332,48 @@ REDUCER(builtin_func_new) {
 
 	e->newe.type = *(type_t*)in[2].ptr;		/* type to alloc */
 	free(in[2].ptr);
-	if(tag==1){
+	if(tag==1 || tag==3){
 		e->newe.expr = in[4].ptr;
 	}
+	if(tag==2 || tag==3){
+		alloc_opts_t *opts = in[tag==2 ? 4 : 6].ptr;
+		e->newe.opts = *opts;
+		free(opts);
+	}
 	out->ptr = e;
 }
 
+REDUCER(alloc_opt) {
+	alloc_opts_t *opts = malloc(sizeof(alloc_opts_t));
+	bzero(opts, sizeof(*opts));
+	if (tag == 0) {
+		opts->noinit = 1;
+	} else if (tag == 1) {
+		opts->align = in[2].ptr;
+	} else {
+		opts->arena = in[2].ptr;
+	}
+	out->ptr = opts;
+}
+
+REDUCER(alloc_opt_list) {
+	alloc_opts_t *opts = in[0].ptr;
+	alloc_opts_t *other = in[2].ptr;
+	if (other->noinit)
+		opts->noinit = 1;
+	if (other->align) {
+		if (opts->align)
+			derror(&other->align->loc, "alignment specified more than once\n");
+		opts->align = other->align;
+	}
+	if (other->arena) {
+		if (opts->arena)
+			derror(&other->arena->loc, "arena specified more than once\n");
+		opts->arena = other->arena;
+	}
+	free(other);
+}
+
 REDUCER(builtin_func_dispose) {
 	expr_t *e = malloc(sizeof(expr_t));
 	bzero(e, sizeof(*e));
@@ -325,6 +383,171 @@ REDUCER(builtin_func_dispose) {
 	out->ptr = e;
 }
 
+REDUCER(builtin_func_append) {
+	expr_t *e = malloc(sizeof(expr_t));
+	bzero(e, sizeof(*e));
+	e->kind = AST_APPEND_BUILTIN;
+	e->loc = in[0].loc;
+	e->append.slice = in[2].ptr;
+	if (tag == 0) {
+		array_t *elems = in[4].ptr;
+		array_shrink(elems);
+		e->append.num_elems = elems->size;
+		e->append.elems = elems->items;
+		free(elems);
+	} else {
+		e->append.num_elems = 1;
+		e->append.elems = in[4].ptr;
+		e->append.spread = 1;
+	}
+	out->ptr = e;
+}
+
+REDUCER(builtin_func_copy) {
+	expr_t *e = malloc(sizeof(expr_t));
+	bzero(e, sizeof(*e));
+	e->kind = AST_COPY_BUILTIN;
+	e->loc = in[0].loc;
+	e->copy.dst = in[2].ptr;
+	e->copy.src = in[4].ptr;
+	out->ptr = e;
+}
+
+REDUCER(builtin_func_shuffle) {
+	expr_t *e = malloc(sizeof(expr_t));
+	bzero(e, sizeof(*e));
+	e->kind = AST_SHUFFLE_BUILTIN;
+	e->loc = in[0].loc;
+	array_t *args = in[2].ptr;
+	array_shrink(args);
+	e->shuffle.num_args = args->size;
+	e->shuffle.args = args->items;
+	free(args);
+	out->ptr = e;
+}
+
+REDUCER(builtin_func_reduce) {
+	static const char *names[] = {
+		[AST_REDUCE_ADD] = "add",
+		[AST_REDUCE_MUL] = "mul",
+		[AST_REDUCE_AND] = "and",
+		[AST_REDUCE_OR]  = "or",
+		[AST_REDUCE_XOR] = "xor",
+		[AST_REDUCE_MIN] = "min",
+		[AST_REDUCE_MAX] = "max",
+	};
+	unsigned op, len = in[2].last - in[2].first;
+	for (op = 0; op < sizeof(names)/sizeof(*names); ++op)
+		if (strlen(names[op]) == len && strncmp(names[op], in[2].first, len) == 0)
+			break;
+	if (op == sizeof(names)/sizeof(*names)) {
+		loc_t loc = in[2].loc;
+		derror(&loc, "unknown reduction '%.*s', expected add, mul, and, or, xor, min, or max\n", len, in[2].first);
+	}
+
+	expr_t *e = malloc(sizeof(expr_t));
+	bzero(e, sizeof(*e));
+	e->kind = AST_REDUCE_BUILTIN;
+	e->loc = in[0].loc;
+	e->reduce.op = op;
+	e->reduce.expr = in[4].ptr;
+	out->ptr = e;
+}
+
+REDUCER(builtin_func_atomic) {
+	static const struct { const char *name; unsigned num_args; } ops[] = {
+		[AST_ATOMIC_LOAD]    = { "load",    1 },
+		[AST_ATOMIC_STORE]   = { "store",   2 },
+		[AST_ATOMIC_XCHG]    = { "xchg",    2 },
+		[AST_ATOMIC_ADD]     = { "add",     2 },
+		[AST_ATOMIC_SUB]     = { "sub",     2 },
+		[AST_ATOMIC_AND]     = { "and",     2 },
+		[AST_ATOMIC_OR]      = { "or",      2 },
+		[AST_ATOMIC_XOR]     = { "xor",     2 },
+		[AST_ATOMIC_MIN]     = { "min",     2 },
+		[AST_ATOMIC_MAX]     = { "max",     2 },
+		[AST_ATOMIC_CMPXCHG] = { "cmpxchg", 3 },
+		[AST_ATOMIC_FENCE]   = { "fence",   0 },
+	};
+	static const char *orders[] = {
+		[AST_ATOMIC_SEQ_CST] = "seq_cst",
+		[AST_ATOMIC_RELAXED] = "relaxed",
+		[AST_ATOMIC_ACQUIRE] = "acquire",
+		[AST_ATOMIC_RELEASE] = "release",
+		[AST_ATOMIC_ACQ_REL] = "acq_rel",
+	};
+	unsigned op, len = in[2].last - in[2].first;
+	for (op = 0; op < sizeof(ops)/sizeof(*ops); ++op)
+		if (strlen(ops[op].name) == len && strncmp(ops[op].name, in[2].first, len) == 0)
+			break;
+	if (op == sizeof(ops)/sizeof(*ops)) {
+		loc_t loc = in[2].loc;
+		derror(&loc, "unknown atomic operation '%.*s'\n", len, in[2].first);
+	}
+
+	expr_t *e = malloc(sizeof(expr_t));
+	bzero(e, sizeof(*e));
+	e->kind = AST_ATOMIC_BUILTIN;
+	e->loc = in[0].loc;
+	e->atomic.op = op;
+	if (tag == 1) {
+		array_t *args = in[4].ptr;
+		array_shrink(args);
+		e->atomic.num_args = args->size;
+		e->atomic.args = args->items;
+		free(args);
+	}
+
+	// An additional last argument names the memory ordering.
+	if (e->atomic.num_args == ops[op].num_args + 1) {
+		expr_t *last = e->atomic.args + ops[op].num_args;
+		unsigned order = sizeof(orders)/sizeof(*orders);
+		if (last->kind == AST_IDENT_EXPR)
+			for (order = 0; order < sizeof(orders)/sizeof(*orders); ++order)
+				if (strcmp(orders[order], last->ident) == 0)
+					break;
+		if (order == sizeof(orders)/sizeof(*orders))
+			derror(&last->loc, "expected memory ordering relaxed, acquire, release, acq_rel, or seq_cst\n");
+		e->atomic.order = order;
+		expr_dispose(last);
+		--e->atomic.num_args;
+	}
+	if (e->atomic.num_args != ops[op].num_args)
+		derror(&e->loc, "atomic %s takes %u arguments and an optional memory ordering\n", ops[op].name, ops[op].num_args);
+	out->ptr = e;
+}
+
+REDUCER(builtin_func_intrinsic) {
+	unsigned op, len = in[2].last - in[2].first;
+	for (op = 0; op < AST_NUM_INTRINSICS; ++op)
+		if (strlen(intrinsic_ops[op].name) == len && strncmp(intrinsic_ops[op].name, in[2].first, len) == 0)
+			break;
+	if (op == AST_NUM_INTRINSICS) {
+		loc_t loc = in[2].loc;
+		derror(&loc, "unknown intrinsic '%.*s'\n", len, in[2].first);
+	}
+
+	expr_t *e = malloc(sizeof(expr_t));
+	bzero(e, sizeof(*e));
+	e->kind = AST_INTRINSIC_BUILTIN;
+	e->loc = in[0].loc;
+	e->intrinsic.op = op;
+	array_t *args = in[4].ptr;
+	array_shrink(args);
+	e->intrinsic.num_args = args->size;
+	e->intrinsic.args = args->items;
+	free(args);
+
+	const struct intrinsic_info *info = intrinsic_ops + op;
+	if (e->intrinsic.num_args < info->min_args || e->intrinsic.num_args > info->max_args) {
+		if (info->min_args == info->max_args)
+			derror(&e->loc, "intrinsic %s takes %u arguments\n", info->name, info->min_args);
+		else
+			derror(&e->loc, "intrinsic %s takes %u to %u arguments\n", info->name, info->min_args, info->max_args);
+	}
+	out->ptr = e;
+}
+
 REDUCER(builtin_func_free) {
 	expr_t *e = malloc(sizeof(expr_t));
 	bzero(e, sizeof(*e));
@@ -340,7 +563,13 @@ REDUCER(builtin_func_make) {
 	e->kind = AST_MAKE_BUILTIN;
 	e->loc = in[0].loc;
 	e->make.type = *(type_t*)in[2].ptr;
+	free(in[2].ptr);
 	e->make.expr = in[4].ptr;
+	if (tag == 1) {
+		alloc_opts_t *opts = in[6].ptr;
+		e->make.opts = *opts;
+		free(opts);
+	}
 	out->ptr = e;
 }
 
@@ -557,6 +786,63 @@ REDUCER(block_item_stmt) {
 
 // --- selection_stmt ----------------------------------------------------------
 
+REDUCER(unchecked_stmt) {
+	stmt_t *s = malloc(sizeof(stmt_t));
+	bzero(s, sizeof(*s));
+	s->kind = AST_UNCHECKED_STMT;
+	s->loc = in[0].loc;
+	s->body = in[1].ptr;
+	out->ptr = s;
+}
+
+REDUCER(hinted_iteration_stmt) {
+	loop_hints_t *hints = in[0].ptr;
+	stmt_t *s = in[1].ptr;
+	if (s->kind != AST_FOR_STMT)
+		derror(&s->loc, "loop hints are only supported on for loops\n");
+	s->iteration.hints = *hints;
+	free(hints);
+	out->ptr = s;
+}
+
+REDUCER(loop_hint) {
+	loop_hints_t *hints = malloc(sizeof(loop_hints_t));
+	bzero(hints, sizeof(*hints));
+	unsigned count = 0;
+	if (tag == 1 || tag == 3) {
+		char *literal = strndup(in[2].first, in[2].last-in[2].first);
+		char *end;
+		count = strtoul(literal, &end, 0);
+		if (*end != 0 || count == 0) {
+			loc_t loc = in[2].loc;
+			derror(&loc, "loop hint count '%s' must be a positive integer\n", literal);
+		}
+		free(literal);
+	}
+	if (tag <= 1) {
+		hints->unroll = 1;
+		hints->unroll_count = count;
+	} else {
+		hints->vectorize = 1;
+		hints->vectorize_width = count;
+	}
+	out->ptr = hints;
+}
+
+REDUCER(loop_hint_list) {
+	loop_hints_t *hints = in[0].ptr;
+	loop_hints_t *other = in[1].ptr;
+	if (other->unroll) {
+		hints->unroll = 1;
+		hints->unroll_count = other->unroll_count;
+	}
+	if (other->vectorize) {
+		hints->vectorize = 1;
+		hints->vectorize_width = other->vectorize_width;
+	}
+	free(other);
+}
+
 REDUCER(selection_stmt_if) {
 	stmt_t *s = malloc(sizeof(stmt_t));
 	bzero(s, sizeof(*s));
@@ -574,8 +860,8 @@ REDUCER(selection_stmt_switch) {
 	bzero(s, sizeof(*s));
 	s->kind = AST_SWITCH_STMT;
 	s->loc = in[0].loc;
-	s->selection.condition = in[2].ptr;
-	s->selection.stmt = in[4].ptr;
+	s->selection.condition = in[1].ptr;
+	s->selection.stmt = in[2].ptr;
 	out->ptr = s;
 }
 
@@ -635,10 +921,20 @@ REDUCER(jump_stmt_goto) {
 	stmt_t *s = malloc(sizeof(stmt_t));
 	bzero(s, sizeof(*s));
 	s->kind = AST_GOTO_STMT;
+	s->loc = in[0].loc;
 	s->name = strndup(in[1].first, in[1].last-in[1].first);
 	out->ptr = s;
 }
 
+REDUCER(jump_stmt_goto_indirect) {
+	stmt_t *s = malloc(sizeof(stmt_t));
+	bzero(s, sizeof(*s));
+	s->kind = AST_INDIRECT_GOTO_STMT;
+	s->loc = in[0].loc;
+	s->expr = in[2].ptr;
+	out->ptr = s;
+}
+
 REDUCER(jump_stmt_continue) {
 	stmt_t *s = malloc(sizeof(stmt_t));
 	bzero(s, sizeof(*s));
@@ -672,8 +968,9 @@ REDUCER(labeled_stmt_name) {
 	stmt_t *s = malloc(sizeof(stmt_t));
 	bzero(s, sizeof(*s));
 	s->kind = AST_LABEL_STMT;
-	s->label.name = strndup(in[0].first, in[0].last-in[0].first);
-	s->label.stmt = in[2].ptr;
+	s->loc = in[0].loc;
+	s->label.name = strndup(in[1].first, in[1].last-in[1].first);
+	s->label.stmt = in[3].ptr;
 	out->ptr = s;
 }
 
@@ -681,6 +978,7 @@ REDUCER(labeled_stmt_case) {
 	stmt_t *s = malloc(sizeof(stmt_t));
 	bzero(s, sizeof(*s));
 	s->kind = AST_CASE_STMT;
+	s->loc = in[0].loc;
 	s->label.expr = in[1].ptr;
 	s->label.stmt = in[3].ptr;
 	out->ptr = s;
@@ -690,6 +988,7 @@ REDUCER(labeled_stmt_default) {
 	stmt_t *s = malloc(sizeof(stmt_t));
 	bzero(s, sizeof(*s));
 	s->kind = AST_DEFAULT_STMT;
+	s->loc = in[0].loc;
 	s->label.stmt = in[2].ptr;
 	out->ptr = s;
 }
@@ -735,6 +1034,12 @@ REDUCER(variable_decl2) {
 	out->ptr = d;
 }
 
+REDUCER(decl_align) {
+	decl_t *d = in[4].ptr;
+	d->variable.align = parse_alignment(in+2);
+	out->ptr = d;
+}
+
 REDUCER(const_decl) {
 	decl_t *d = malloc(sizeof(decl_t));
 	bzero(d, sizeof(*d));
@@ -800,18 +1105,50 @@ REDUCER(type_void) {
 	out->ptr = t;
 }
 
+/// Parses the `be` or `le` suffix of an integer type such as `uint32be`.
+static void
+parse_byte_order(const token_t *tkn, type_t *t, const char *suffix) {
+	while (*suffix >= '0' && *suffix <= '9')
+		++suffix;
+	if (*suffix == 0)
+		return;
+	if (strcmp(suffix, "be") == 0)
+		t->byte_order = AST_BIG_ENDIAN;
+	else if (strcmp(suffix, "le") == 0)
+		t->byte_order = AST_LITTLE_ENDIAN;
+	else
+		return;
+	if (t->width == 0 || t->width % 16 != 0) {
+		loc_t loc = tkn->loc;
+		derror(&loc, "byte order requires an integer of a multiple of 16 bits, got %u bits\n", t->width);
+	}
+}
+
 REDUCER(type_name) {
 	type_t *t = malloc(sizeof(type_t));
 	bzero(t, sizeof(*t));
 	const char *name = in[0].first;
 	unsigned len = in[0].last-in[0].first;
-	if (len >= 3 && strncmp(name, "int", 3) == 0) {
+	if (len >= 4 && strncmp(name, "uint", 4) == 0) {
+		t->kind = AST_INTEGER_TYPE;
+		t->is_unsigned = 1;
+		if (len > 4) {
+			char suffix[len-4+1];
+			strncpy(suffix, name+4, len-4);
+			suffix[len-4] = 0;
+			t->width = atoi(suffix);
+			parse_byte_order(in, t, suffix);
+		} else {
+			t->width = 32;
+		}
+	} else if (len >= 3 && strncmp(name, "int", 3) == 0) {
 		t->kind = AST_INTEGER_TYPE;
 		if (len > 3) {
 			char suffix[len-3+1];
 			strncpy(suffix, name+3, len-3);
 			suffix[len-3] = 0;
 			t->width = atoi(suffix);
+			parse_byte_order(in, t, suffix);
 		} else {
 			t->width = 32;
 		}
@@ -841,10 +1178,15 @@ REDUCER(type_pointer) {
 }
 
 REDUCER(type_struct) {
-	type_t *t = malloc(sizeof(type_t));
-	bzero(t, sizeof(*t));
-	t->kind = AST_STRUCT_TYPE;
-	array_t *a = in[2].ptr;
+	type_t *t;
+	if (tag == 1) {
+		t = in[1].ptr;
+	} else {
+		t = malloc(sizeof(type_t));
+		bzero(t, sizeof(*t));
+		t->kind = AST_STRUCT_TYPE;
+	}
+	array_t *a = in[tag == 1 ? 3 : 2].ptr;
 	array_shrink(a);
 	t->strct.num_members = a->size;
 	t->strct.members = a->items;
@@ -865,11 +1207,25 @@ REDUCER(struct_member_list) {
 	}
 }
 
+/// Parses the width of a bitfield member.
+static unsigned
+parse_bits(const token_t *tkn) {
+	unsigned bits = atoi(tkn->first);
+	if (bits == 0) {
+		loc_t loc = tkn->loc;
+		derror(&loc, "bitfield must be at least one bit wide\n");
+	}
+	return bits;
+}
+
 REDUCER(struct_member) {
 	struct_member_t *m = malloc(sizeof(struct_member_t));
 	bzero(m, sizeof(*m));
 	m->type = in[0].ptr;
 	m->name = strndup(in[1].first, in[1].last-in[1].first);
+	m->loc = in[1].loc;
+	if (tag == 1)
+		m->bits = parse_bits(in+3);
 	out->ptr = m;
 }
 
@@ -877,10 +1233,44 @@ REDUCER(struct_member2) {
 	struct_member_t *m = malloc(sizeof(struct_member_t));
 	bzero(m, sizeof(*m));
 	m->name = strndup(in[0].first, in[0].last-in[0].first);
+	m->loc = in[0].loc;
 	m->type = in[2].ptr;
+	if (tag == 1)
+		m->bits = parse_bits(in+4);
 	out->ptr = m;
 }
 
+REDUCER(struct_member_align) {
+	struct_member_t *m = in[4].ptr;
+	m->align = parse_alignment(in+2);
+	out->ptr = m;
+}
+
+REDUCER(struct_attr) {
+	type_t *t = malloc(sizeof(type_t));
+	bzero(t, sizeof(*t));
+	t->kind = AST_STRUCT_TYPE;
+	if (tag == 0)
+		t->strct.packed = 1;
+	else
+		t->strct.align = parse_alignment(in+2);
+	out->ptr = t;
+}
+
+REDUCER(struct_attr_list) {
+	type_t *t = in[0].ptr;
+	type_t *other = in[1].ptr;
+	if (other->strct.align) {
+		if (t->strct.align) {
+			loc_t loc = in[1].loc;
+			derror(&loc, "alignment specified more than once\n");
+		}
+		t->strct.align = other->strct.align;
+	}
+	t->strct.packed |= other->strct.packed;
+	free(other);
+}
+
 REDUCER(type_array) {
 	type_t *t = malloc(sizeof(type_t));
 	bzero(t, sizeof(*t));
@@ -898,6 +1288,24 @@ REDUCER(type_slice) {
 	out->ptr = t;
 }
 
+REDUCER(type_vector) {
+	type_t *t = malloc(sizeof(type_t));
+	bzero(t, sizeof(*t));
+	t->kind = AST_VECTOR_TYPE;
+	t->vector.type = in[4].ptr;
+	t->vector.length = atoi(in[2].first);
+	t->vector.loc = in[0].loc;
+	if (t->vector.length == 0 || t->vector.type->pointer > 0 || (
+	    t->vector.type->kind != AST_INTEGER_TYPE &&
+	    t->vector.type->kind != AST_FLOAT_TYPE &&
+	    t->vector.type->kind != AST_BOOLEAN_TYPE &&
+	    t->vector.type->kind != AST_NAMED_TYPE)) {
+		loc_t loc = in[0].loc;
+		derror(&loc, "vectors must have at least one lane of integer, float, or bool type\n");
+	}
+	out->ptr = t;
+}
+
 REDUCER(type_func) {
 	type_t *t = malloc(sizeof(type_t));
 	bzero(t, sizeof(*t));
@@ -1024,18 +1432,82 @@ REDUCER(decl_unit) {
 	unit_t *u = malloc(sizeof(unit_t));
 	bzero(u, sizeof(*u));
 	u->kind = AST_DECL_UNIT;
-	u->decl = in->ptr;
+	u->decl = in[tag == 0 ? 0 : tag == 1 ? 1 : 4].ptr;
 	u->loc = u->decl->loc;
 	out->ptr = u;
+	if (tag > 0 && u->decl->kind != AST_VARIABLE_DECL)
+		derror(&u->loc, "only variables can be thread-local\n");
+
+	if (tag == 1) {
+		u->decl->variable.tls_model = AST_TLS_GENERAL_DYNAMIC;
+	} else if (tag == 2) {
+		static const char *models[] = {
+			[AST_TLS_GENERAL_DYNAMIC] = "general_dynamic",
+			[AST_TLS_LOCAL_DYNAMIC] = "local_dynamic",
+			[AST_TLS_INITIAL_EXEC] = "initial_exec",
+			[AST_TLS_LOCAL_EXEC] = "local_exec",
+		};
+		size_t len = in[2].last - in[2].first;
+		unsigned i;
+		for (i = AST_TLS_GENERAL_DYNAMIC; i <= AST_TLS_LOCAL_EXEC; ++i)
+			if (strlen(models[i]) == len && strncmp(models[i], in[2].first, len) == 0)
+				break;
+		if (i > AST_TLS_LOCAL_EXEC) {
+			loc_t loc = in[2].loc;
+			derror(&loc, "unknown thread-local storage model '%.*s'\n", (int)len, in[2].first);
+		}
+		u->decl->variable.tls_model = i;
+	}
 }
 
 REDUCER(func_unit) {
+	if (tag >= 2) {
+		unsigned *attrs = in[0].ptr;
+		unit_t *u = in[1].ptr;
+		if (tag == 3)
+			u->func.body = in[2].ptr;
+		u->func.is_const = (*attrs & AST_FUNC_CONST) != 0;
+		u->func.attrs = *attrs & ~AST_FUNC_CONST;
+		free(attrs);
+		if (u->func.is_const && !u->func.body)
+			derror(&u->loc, "const function '%s' requires a body\n", u->func.name);
+		if ((u->func.attrs & (AST_FUNC_INLINE | AST_FUNC_ALWAYS_INLINE)) && !u->func.body)
+			derror(&u->loc, "inline function '%s' requires a body\n", u->func.name);
+		if ((u->func.attrs & AST_FUNC_NOINLINE) && (u->func.attrs & (AST_FUNC_INLINE | AST_FUNC_ALWAYS_INLINE)))
+			derror(&u->loc, "function '%s' cannot be both inline and noinline\n", u->func.name);
+		if ((u->func.attrs & AST_FUNC_HOT) && (u->func.attrs & AST_FUNC_COLD))
+			derror(&u->loc, "function '%s' cannot be both hot and cold\n", u->func.name);
+		out->ptr = u;
+		return;
+	}
 	unit_t *u = in->ptr;
 	if (tag == 1)
 		u->func.body = in[1].ptr;
 	out->ptr = u;
 }
 
+REDUCER(func_attr) {
+	static const unsigned flags[] = {
+		AST_FUNC_CONST,
+		AST_FUNC_INLINE,
+		AST_FUNC_ALWAYS_INLINE,
+		AST_FUNC_NOINLINE,
+		AST_FUNC_HOT,
+		AST_FUNC_COLD,
+		AST_FUNC_PURE,
+	};
+	unsigned *attrs = malloc(sizeof(unsigned));
+	*attrs = flags[tag];
+	out->ptr = attrs;
+}
+
+REDUCER(func_attr_list) {
+	unsigned *attrs = in[0].ptr;
+	unsigned *other = in[1].ptr;
+	*attrs |= *other;
+	free(other);
+}
+
 REDUCER(func_unit_decl) {
 	unit_t *u = malloc(sizeof(unit_t));
 	bzero(u, sizeof(*u));
@@ -1094,7 +1566,11 @@ REDUCER(parameter) {
 	func_param_t *p = malloc(sizeof(func_param_t));
 	bzero(p, sizeof(*p));
 	unsigned i = 0;
-	if (tag == 1) {
+	if (tag == 2) {
+		p->noalias = 1;
+		++i;
+	}
+	if (tag == 1 || tag == 2) {
 		p->name = strndup(in[i].first, in[i].last-in[i].first);
 		++i;
 	}
@@ -36,6 +36,7 @@ RULE(unary_expr) \
 	VAR TKN(INC_OP) SUB(unary_expr) REDUCE_TAG(unary_expr_incdec, 0) \
 	VAR TKN(DEC_OP) SUB(unary_expr) REDUCE_TAG(unary_expr_incdec, 1) \
 	VAR SUB(unary_op) SUB(cast_expr) REDUCE(unary_expr_op) \
+	VAR TKN(AND_OP) TKN(IDENT) REDUCE(unary_expr_label_addr) \
 	VAR TKN(SIZEOF) SUB(unary_expr) REDUCE_TAG(unary_expr_sizeof, 0) \
 	/*TODO: add parenthesis */ \
 	VAR TKN(SIZEOF) TKN(HASH) SUB(type) REDUCE_TAG(unary_expr_sizeof, 1) \
@@ -44,12 +45,34 @@ RULE_END \
 \
 RULE(builtin_func) \
 	VAR TKN(NEW) TKN(LPAREN) SUB(type) TKN(RPAREN) REDUCE_TAG(builtin_func_new,0) \
-	VAR TKN(NEW) TKN(LPAREN) SUB(type) TKN(COMMA) SUB(expr) TKN(RPAREN) REDUCE_TAG(builtin_func_new,1) \
+	VAR TKN(NEW) TKN(LPAREN) SUB(type) TKN(COMMA) SUB(assignment_expr) TKN(RPAREN) REDUCE_TAG(builtin_func_new,1) \
+	VAR TKN(NEW) TKN(LPAREN) SUB(type) TKN(COMMA) SUB(alloc_opt_list) TKN(RPAREN) REDUCE_TAG(builtin_func_new,2) \
+	VAR TKN(NEW) TKN(LPAREN) SUB(type) TKN(COMMA) SUB(assignment_expr) TKN(COMMA) SUB(alloc_opt_list) TKN(RPAREN) REDUCE_TAG(builtin_func_new,3) \
 	VAR TKN(FREE) TKN(LPAREN) SUB(expr) TKN(RPAREN) REDUCE(builtin_func_free) \
-	VAR TKN(MAKE) TKN(LPAREN) SUB(type) TKN(COMMA) SUB(expr) TKN(RPAREN) REDUCE(builtin_func_make) \
+	VAR TKN(MAKE) TKN(LPAREN) SUB(type) TKN(COMMA) SUB(assignment_expr) TKN(RPAREN) REDUCE_TAG(builtin_func_make,0) \
+	VAR TKN(MAKE) TKN(LPAREN) SUB(type) TKN(COMMA) SUB(assignment_expr) TKN(COMMA) SUB(alloc_opt_list) TKN(RPAREN) REDUCE_TAG(builtin_func_make,1) \
 	VAR TKN(LEN) TKN(LPAREN) SUB(expr) TKN(RPAREN) REDUCE_TAG(builtin_func_lencap,0) \
 	VAR TKN(CAP) TKN(LPAREN) SUB(expr) TKN(RPAREN) REDUCE_TAG(builtin_func_lencap,1) \
 	VAR TKN(DISPOSE) TKN(LPAREN) SUB(expr) TKN(RPAREN) REDUCE(builtin_func_dispose) \
+	VAR TKN(APPEND) TKN(LPAREN) SUB(assignment_expr) TKN(COMMA) SUB(argument_expr_list) TKN(RPAREN) REDUCE_TAG(builtin_func_append,0) \
+	VAR TKN(APPEND) TKN(LPAREN) SUB(assignment_expr) TKN(COMMA) SUB(assignment_expr) TKN(ELLIPSIS) TKN(RPAREN) REDUCE_TAG(builtin_func_append,1) \
+	VAR TKN(COPY) TKN(LPAREN) SUB(assignment_expr) TKN(COMMA) SUB(assignment_expr) TKN(RPAREN) REDUCE(builtin_func_copy) \
+	VAR TKN(SHUFFLE) TKN(LPAREN) SUB(argument_expr_list) TKN(RPAREN) REDUCE(builtin_func_shuffle) \
+	VAR TKN(REDUCE) TKN(LPAREN) TKN(IDENT) TKN(COMMA) SUB(assignment_expr) TKN(RPAREN) REDUCE(builtin_func_reduce) \
+	VAR TKN(ATOMIC) TKN(LPAREN) TKN(IDENT) TKN(RPAREN) REDUCE_TAG(builtin_func_atomic,0) \
+	VAR TKN(ATOMIC) TKN(LPAREN) TKN(IDENT) TKN(COMMA) SUB(argument_expr_list) TKN(RPAREN) REDUCE_TAG(builtin_func_atomic,1) \
+	VAR TKN(INTRINSIC) TKN(LPAREN) TKN(IDENT) TKN(COMMA) SUB(argument_expr_list) TKN(RPAREN) REDUCE(builtin_func_intrinsic) \
+RULE_END \
+\
+RULE(alloc_opt_list) \
+	VAR SUB(alloc_opt) REDUCE_DEFAULT \
+	VAR SUB(alloc_opt_list) TKN(COMMA) SUB(alloc_opt) REDUCE(alloc_opt_list) \
+RULE_END \
+\
+RULE(alloc_opt) \
+	VAR TKN(NOINIT) REDUCE_TAG(alloc_opt,0) \
+	VAR TKN(ALIGNAS) TKN(LPAREN) SUB(expr) TKN(RPAREN) REDUCE_TAG(alloc_opt,1) \
+	VAR TKN(IN) TKN(LPAREN) SUB(expr) TKN(RPAREN) REDUCE_TAG(alloc_opt,2) \
 RULE_END \
 \
 RULE(unary_op) \
@@ -181,7 +204,7 @@ RULE_END \
 RULE(selection_stmt) \
 	VAR TKN(IF) SUB(expr) SUB(compound_stmt) REDUCE_TAG(selection_stmt_if, 0) \
 	VAR TKN(IF) SUB(expr) SUB(compound_stmt) TKN(ELSE) SUB(stmt) REDUCE_TAG(selection_stmt_if, 1) \
-	VAR TKN(SWITCH) TKN(LPAREN) SUB(expr) TKN(RPAREN) SUB(stmt) REDUCE(selection_stmt_switch) \
+	VAR TKN(SWITCH) SUB(expr) SUB(compound_stmt) REDUCE(selection_stmt_switch) \
 RULE_END \
 \
 RULE(iteration_stmt) \
@@ -212,6 +235,7 @@ RULE_END \
 \
 RULE(jump_stmt) \
 	VAR TKN(GOTO) TKN(IDENT) TKN(SEMICOLON) REDUCE(jump_stmt_goto) \
+	VAR TKN(GOTO) TKN(MUL_OP) SUB(expr) TKN(SEMICOLON) REDUCE(jump_stmt_goto_indirect) \
 	VAR TKN(CONTINUE) TKN(SEMICOLON) REDUCE(jump_stmt_continue) \
 	VAR TKN(BREAK) TKN(SEMICOLON) REDUCE(jump_stmt_break) \
 	VAR TKN(RETURN) TKN(SEMICOLON) REDUCE_TAG(jump_stmt_return, 0) \
@@ -219,7 +243,7 @@ RULE(jump_stmt) \
 RULE_END \
 \
 RULE(labeled_stmt) \
-	/*VAR TKN(IDENT) TKN(COLON) SUB(stmt) REDUCE(labeled_stmt_name)*/ \
+	VAR TKN(LABEL) TKN(IDENT) TKN(COLON) SUB(stmt) REDUCE(labeled_stmt_name) \
 	VAR TKN(CASE) SUB(expr) TKN(COLON) SUB(stmt) REDUCE(labeled_stmt_case) \
 	VAR TKN(DEFAULT) TKN(COLON) SUB(stmt) REDUCE(labeled_stmt_default) \
 RULE_END \
@@ -231,6 +255,20 @@ RULE(stmt) \
 	VAR SUB(iteration_stmt) REDUCE_DEFAULT \
 	VAR SUB(jump_stmt) REDUCE_DEFAULT \
 	VAR SUB(labeled_stmt) REDUCE_DEFAULT \
+	VAR TKN(UNCHECKED) SUB(compound_stmt) REDUCE(unchecked_stmt) \
+	VAR SUB(loop_hint_list) SUB(iteration_stmt) REDUCE(hinted_iteration_stmt) \
+RULE_END \
+\
+RULE(loop_hint_list) \
+	VAR SUB(loop_hint) REDUCE_DEFAULT \
+	VAR SUB(loop_hint_list) SUB(loop_hint) REDUCE(loop_hint_list) \
+RULE_END \
+\
+RULE(loop_hint) \
+	VAR TKN(UNROLL) REDUCE_TAG(loop_hint,0) \
+	VAR TKN(UNROLL) TKN(LPAREN) TKN(NUMBER_LITERAL) TKN(RPAREN) REDUCE_TAG(loop_hint,1) \
+	VAR TKN(VECTORIZE) REDUCE_TAG(loop_hint,2) \
+	VAR TKN(VECTORIZE) TKN(LPAREN) TKN(NUMBER_LITERAL) TKN(RPAREN) REDUCE_TAG(loop_hint,3) \
 RULE_END \
 \
 \
@@ -266,6 +304,7 @@ RULE_END \
 \
 RULE(decl) \
 	VAR SUB(variable_decl) REDUCE_DEFAULT \
+	VAR TKN(ALIGNAS) TKN(LPAREN) TKN(NUMBER_LITERAL) TKN(RPAREN) SUB(variable_decl) REDUCE(decl_align) \
 	VAR SUB(const_decl) REDUCE_DEFAULT \
 	VAR SUB(implementation_decl) REDUCE_DEFAULT \
 RULE_END \
@@ -278,9 +317,11 @@ RULE(type) \
 	VAR TKN(VOID) REDUCE(type_void) \
 	VAR TKN(IDENT) REDUCE(type_name) \
 	VAR TKN(MUL_OP) SUB(type) REDUCE(type_pointer) \
-	VAR TKN(STRUCT) TKN(LBRACE) SUB(struct_member_list) TKN(RBRACE) REDUCE(type_struct) \
+	VAR TKN(STRUCT) TKN(LBRACE) SUB(struct_member_list) TKN(RBRACE) REDUCE_TAG(type_struct, 0) \
+	VAR TKN(STRUCT) SUB(struct_attr_list) TKN(LBRACE) SUB(struct_member_list) TKN(RBRACE) REDUCE_TAG(type_struct, 1) \
 	VAR TKN(LBRACK) TKN(NUMBER_LITERAL) TKN(RBRACK) SUB(type) REDUCE(type_array) \
 	VAR TKN(LBRACK) TKN(RBRACK) SUB(type) REDUCE(type_slice) \
+	VAR TKN(VEC) TKN(LT_OP) TKN(NUMBER_LITERAL) TKN(COMMA) SUB(type) TKN(GT_OP) REDUCE(type_vector) \
 	VAR TKN(FUNC) TKN(LPAREN) TKN(RPAREN) SUB(type) REDUCE_TAG(type_func,0) \
 	VAR TKN(FUNC) TKN(LPAREN) SUB(func_type_args) TKN(RPAREN) SUB(type) REDUCE_TAG(type_func,1) \
 	VAR TKN(INTERFACE) TKN(LBRACE) TKN(RBRACE) REDUCE_TAG(type_interface, 0) \
@@ -292,9 +333,22 @@ RULE(struct_member_list) \
 	VAR SUB(struct_member_list) SUB(struct_member) REDUCE_TAG(struct_member_list, 1) \
 RULE_END \
 \
+RULE(struct_attr_list) \
+	VAR SUB(struct_attr) REDUCE_DEFAULT \
+	VAR SUB(struct_attr_list) SUB(struct_attr) REDUCE(struct_attr_list) \
+RULE_END \
+\
+RULE(struct_attr) \
+	VAR TKN(PACKED) REDUCE_TAG(struct_attr, 0) \
+	VAR TKN(ALIGNAS) TKN(LPAREN) TKN(NUMBER_LITERAL) TKN(RPAREN) REDUCE_TAG(struct_attr, 1) \
+RULE_END \
+\
 RULE(struct_member) \
-	VAR SUB(type) TKN(IDENT) TKN(SEMICOLON) REDUCE(struct_member) \
-	VAR TKN(IDENT) TKN(COLON) SUB(type) TKN(SEMICOLON) REDUCE(struct_member2) \
+	VAR SUB(type) TKN(IDENT) TKN(SEMICOLON) REDUCE_TAG(struct_member, 0) \
+	VAR SUB(type) TKN(IDENT) TKN(COLON) TKN(NUMBER_LITERAL) TKN(SEMICOLON) REDUCE_TAG(struct_member, 1) \
+	VAR TKN(IDENT) TKN(COLON) SUB(type) TKN(SEMICOLON) REDUCE_TAG(struct_member2, 0) \
+	VAR TKN(IDENT) TKN(COLON) SUB(type) TKN(COLON) TKN(NUMBER_LITERAL) TKN(SEMICOLON) REDUCE_TAG(struct_member2, 1) \
+	VAR TKN(ALIGNAS) TKN(LPAREN) TKN(NUMBER_LITERAL) TKN(RPAREN) SUB(struct_member) REDUCE(struct_member_align) \
 RULE_END \
 \
 RULE(func_type_args) \
@@ -335,12 +389,31 @@ RULE(package_unit) \
 RULE_END \
 \
 RULE(decl_unit) \
-	VAR SUB(decl) REDUCE(decl_unit) \
+	VAR SUB(decl) REDUCE_TAG(decl_unit, 0) \
+	VAR TKN(THREAD_LOCAL) SUB(decl) REDUCE_TAG(decl_unit, 1) \
+	VAR TKN(THREAD_LOCAL) TKN(LPAREN) TKN(IDENT) TKN(RPAREN) SUB(decl) REDUCE_TAG(decl_unit, 2) \
 RULE_END \
 \
 RULE(func_unit) \
 	VAR SUB(func_unit_decl) TKN(SEMICOLON) REDUCE_TAG(func_unit, 0) \
 	VAR SUB(func_unit_decl) SUB(compound_stmt) REDUCE_TAG(func_unit, 1) \
+	VAR SUB(func_attr_list) SUB(func_unit_decl2) TKN(SEMICOLON) REDUCE_TAG(func_unit, 2) \
+	VAR SUB(func_attr_list) SUB(func_unit_decl2) SUB(compound_stmt) REDUCE_TAG(func_unit, 3) \
+RULE_END \
+\
+RULE(func_attr_list) \
+	VAR SUB(func_attr) REDUCE_DEFAULT \
+	VAR SUB(func_attr_list) SUB(func_attr) REDUCE(func_attr_list) \
+RULE_END \
+\
+RULE(func_attr) \
+	VAR TKN(CONST) REDUCE_TAG(func_attr, 0) \
+	VAR TKN(INLINE) REDUCE_TAG(func_attr, 1) \
+	VAR TKN(ALWAYS_INLINE) REDUCE_TAG(func_attr, 2) \
+	VAR TKN(NOINLINE) REDUCE_TAG(func_attr, 3) \
+	VAR TKN(HOT) REDUCE_TAG(func_attr, 4) \
+	VAR TKN(COLD) REDUCE_TAG(func_attr, 5) \
+	VAR TKN(PURE) REDUCE_TAG(func_attr, 6) \
 RULE_END \
 \
 RULE(func_unit_decl) \
@@ -348,6 +421,10 @@ RULE(func_unit_decl) \
 	VAR SUB(type) TKN(IDENT) TKN(LPAREN) TKN(ELLIPSIS) TKN(RPAREN) REDUCE_TAG(func_unit_decl, 1) \
 	VAR SUB(type) TKN(IDENT) TKN(LPAREN) SUB(parameter_list) TKN(RPAREN) REDUCE_TAG(func_unit_decl, 2) \
 	VAR SUB(type) TKN(IDENT) TKN(LPAREN) SUB(parameter_list) TKN(COMMA) TKN(ELLIPSIS) TKN(RPAREN) REDUCE_TAG(func_unit_decl, 3) \
+	VAR SUB(func_unit_decl2) REDUCE_DEFAULT \
+RULE_END \
+\
+RULE(func_unit_decl2) \
 	VAR TKN(FUNC) TKN(IDENT) TKN(LPAREN) TKN(RPAREN) SUB(type) REDUCE_TAG(func_unit_decl2, 0) \
 	VAR TKN(FUNC) TKN(IDENT) TKN(LPAREN) TKN(ELLIPSIS) TKN(RPAREN) SUB(type) REDUCE_TAG(func_unit_decl2, 1) \
 	VAR TKN(FUNC) TKN(IDENT) TKN(LPAREN) SUB(parameter_list) TKN(RPAREN) SUB(type) REDUCE_TAG(func_unit_decl2, 2) \
@@ -362,6 +439,7 @@ RULE_END \
 RULE(parameter) \
 	VAR SUB(type) REDUCE_TAG(parameter, 0) \
 	VAR TKN(IDENT) SUB(type) REDUCE_TAG(parameter, 1) \
+	VAR TKN(RESTRICT) TKN(IDENT) SUB(type) REDUCE_TAG(parameter, 2) \
 RULE_END \
 \
 RULE(type_unit) \
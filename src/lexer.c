@@ -277,12 +277,16 @@ lexer_next (lexer_t *self) {
 		if (self->token == TKN_IDENT) {
 			#define CHECK_KEYWORD(kw,tkn) if (match_keyword(kw, self->base, self->ptr)) self->token = tkn;
 			CHECK_KEYWORD("alignas",   TKN_ALIGNAS);
+			CHECK_KEYWORD("always_inline", TKN_ALWAYS_INLINE);
+			CHECK_KEYWORD("append",    TKN_APPEND);
 			CHECK_KEYWORD("atomic",    TKN_ATOMIC);
 			CHECK_KEYWORD("break",     TKN_BREAK);
 			CHECK_KEYWORD("cap",       TKN_CAP);
 			CHECK_KEYWORD("case",      TKN_CASE);
+			CHECK_KEYWORD("cold",      TKN_COLD);
 			CHECK_KEYWORD("const",     TKN_CONST);
 			CHECK_KEYWORD("continue",  TKN_CONTINUE);
+			CHECK_KEYWORD("copy",      TKN_COPY);
 			CHECK_KEYWORD("default",   TKN_DEFAULT);
 			CHECK_KEYWORD("dispose",   TKN_DISPOSE);
 			CHECK_KEYWORD("do",        TKN_DO);
@@ -293,23 +297,39 @@ lexer_next (lexer_t *self) {
 			CHECK_KEYWORD("free",      TKN_FREE);
 			CHECK_KEYWORD("func",      TKN_FUNC);
 			CHECK_KEYWORD("goto",      TKN_GOTO);
+			CHECK_KEYWORD("hot",       TKN_HOT);
 			CHECK_KEYWORD("if",        TKN_IF);
 			CHECK_KEYWORD("import",    TKN_IMPORT);
+			CHECK_KEYWORD("in",        TKN_IN);
 			CHECK_KEYWORD("inline",    TKN_INLINE);
 			CHECK_KEYWORD("interface", TKN_INTERFACE);
+			CHECK_KEYWORD("intrinsic", TKN_INTRINSIC);
+			CHECK_KEYWORD("label",     TKN_LABEL);
 			CHECK_KEYWORD("len",       TKN_LEN);
 			CHECK_KEYWORD("make",      TKN_MAKE);
 			CHECK_KEYWORD("new",       TKN_NEW);
+			CHECK_KEYWORD("noinit",    TKN_NOINIT);
+			CHECK_KEYWORD("noinline",  TKN_NOINLINE);
 			CHECK_KEYWORD("package",   TKN_PACKAGE);
+			CHECK_KEYWORD("packed",    TKN_PACKED);
+			CHECK_KEYWORD("pure",      TKN_PURE);
+			CHECK_KEYWORD("reduce",    TKN_REDUCE);
+			CHECK_KEYWORD("restrict",  TKN_RESTRICT);
 			CHECK_KEYWORD("return",    TKN_RETURN);
+			CHECK_KEYWORD("shuffle",   TKN_SHUFFLE);
 			CHECK_KEYWORD("sizeof",    TKN_SIZEOF);
 			CHECK_KEYWORD("static",    TKN_STATIC);
 			CHECK_KEYWORD("struct",    TKN_STRUCT);
 			CHECK_KEYWORD("switch",    TKN_SWITCH);
+			CHECK_KEYWORD("thread_local", TKN_THREAD_LOCAL);
 			CHECK_KEYWORD("type",      TKN_TYPE);
 			CHECK_KEYWORD("typedef",   TKN_TYPEDEF);
+			CHECK_KEYWORD("unchecked", TKN_UNCHECKED);
 			CHECK_KEYWORD("union",     TKN_UNION);
+			CHECK_KEYWORD("unroll",    TKN_UNROLL);
 			CHECK_KEYWORD("var",       TKN_VAR);
+			CHECK_KEYWORD("vec",       TKN_VEC);
+			CHECK_KEYWORD("vectorize", TKN_VECTORIZE);
 			CHECK_KEYWORD("void",      TKN_VOID);
 			CHECK_KEYWORD("volatile",  TKN_VOLATILE);
 			CHECK_KEYWORD("while",     TKN_WHILE);
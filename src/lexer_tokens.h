@@ -61,9 +61,11 @@ TKN(SEMICOLON, ";") \
 \
 /* keywords */ \
 TKN(ALIGNAS, "alignas") \
+TKN(ALWAYS_INLINE, "always_inline") \
 TKN(ATOMIC, "atomic") \
 TKN(BREAK, "break") \
 TKN(CASE, "case") \
+TKN(COLD, "cold") \
 TKN(CONST, "const") \
 TKN(CONTINUE, "continue") \
 TKN(DEFAULT, "default") \
@@ -74,26 +76,44 @@ TKN(EXTERN, "extern") \
 TKN(FOR, "for") \
 TKN(FUNC, "func") \
 TKN(GOTO, "goto") \
+TKN(HOT, "hot") \
 TKN(IF, "if") \
 TKN(IMPORT, "import") \
+TKN(IN, "in") \
 TKN(INLINE, "inline") \
 TKN(INTERFACE, "interface") \
+TKN(INTRINSIC, "intrinsic") \
+TKN(LABEL, "label") \
 TKN(NEW, "new") \
+TKN(NOINIT, "noinit") \
+TKN(NOINLINE, "noinline") \
 TKN(FREE, "free") \
 TKN(MAKE, "make") \
 TKN(LEN, "len") \
 TKN(CAP, "cap") \
 TKN(PACKAGE, "package") \
+TKN(PACKED, "packed") \
+TKN(PURE, "pure") \
 TKN(DISPOSE, "dispose") \
+TKN(APPEND, "append") \
+TKN(COPY, "copy") \
+TKN(SHUFFLE, "shuffle") \
+TKN(REDUCE, "reduce") \
+TKN(RESTRICT, "restrict") \
 TKN(RETURN, "return") \
 TKN(SIZEOF, "sizeof") \
 TKN(STATIC, "static") \
 TKN(STRUCT, "struct") \
 TKN(SWITCH, "switch") \
+TKN(THREAD_LOCAL, "thread_local") \
 TKN(TYPE, "type") \
 TKN(TYPEDEF, "typedef") \
+TKN(UNCHECKED, "unchecked") \
 TKN(UNION, "union") \
+TKN(UNROLL, "unroll") \
 TKN(VAR, "var") \
+TKN(VEC, "vec") \
+TKN(VECTORIZE, "vectorize") \
 TKN(VOID, "void") \
 TKN(VOLATILE, "volatile") \
 TKN(WHILE, "while") \
@@ -127,6 +127,7 @@ compile (const char *inname, const char *outname, LLVMModuleRef *module) {
 	bzero(&cg, sizeof cg);
 	codegen_context_init(&ctx);
 	cg.module = LLVMModuleCreateWithName(inname);
+	codegen_set_target(cg.module);
 
 	// Resolve all imports, populating the codegen context with the declarations
 	// of the imported files.
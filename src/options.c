@@ -2,6 +2,7 @@
 #include "options.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 struct options options = { 0 };
@@ -39,6 +40,44 @@ parse_short_option(char opt, char ***argv, char **arge) {
 /// \c arge.
 void
 parse_long_option(char *opt, char ***argv, char **arge) {
+	char *value = strchr(opt, '=');
+	if (value)
+		*value++ = 0;
+
+	// The --alloc and --free options route the new/make and free/dispose
+	// builtins to user-supplied functions instead of malloc and free. The
+	// allocation function is called with the size and alignment of the memory
+	// to allocate as int64 arguments and shall return a *int8. The release
+	// function is called with the *int8 to release.
+	if (strcmp(opt, "alloc") == 0 || strcmp(opt, "free") == 0) {
+		if (!value || !*value) {
+			fprintf(stderr, "expected function name after --%s=\n", opt);
+			exit(1);
+		}
+		if (opt[0] == 'a')
+			options.alloc_func = value;
+		else
+			options.free_func = value;
+		return;
+	}
+
+	// The --checks option selects how runtime safety checks are emitted. They
+	// either trap (the default), are omitted entirely, or report the failure
+	// through a call to low_check_failed before terminating.
+	if (strcmp(opt, "checks") == 0) {
+		if (value && strcmp(value, "trap") == 0)
+			options.checks = CHECKS_TRAP;
+		else if (value && strcmp(value, "none") == 0)
+			options.checks = CHECKS_NONE;
+		else if (value && strcmp(value, "report") == 0)
+			options.checks = CHECKS_REPORT;
+		else {
+			fprintf(stderr, "expected none, trap, or report after --checks=\n");
+			exit(1);
+		}
+		return;
+	}
+
 	fprintf(stderr, "unknown option --%s\n", opt);
 	exit(1);
 }
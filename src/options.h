@@ -1,8 +1,18 @@
 /* Copyright (c) 2015-2016 Fabian Schuiki */
 #pragma once
 
+/// How runtime safety checks such as slice bounds checks are emitted.
+enum checks_mode {
+	CHECKS_TRAP = 0,
+	CHECKS_NONE,
+	CHECKS_REPORT,
+};
+
 extern struct options {
 	char *output_name;
+	char *alloc_func;
+	char *free_func;
+	unsigned checks;
 } options;
 
 void parse_short_option(char opt, char ***argv, char **arge);
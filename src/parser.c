@@ -15,6 +15,72 @@ struct parser_stack {
 };
 
 
+/*
+ * Keywords that only have a meaning in a few positions, such as attributes
+ * and builtins. Where the grammar cannot continue with the keyword but can
+ * with an identifier, they are parsed as an identifier instead, such that
+ * programs may keep using these words as names.
+ */
+static int
+is_soft_keyword (int token) {
+	switch (token) {
+		case TKN_ALWAYS_INLINE:
+		case TKN_APPEND:
+		case TKN_COLD:
+		case TKN_COPY:
+		case TKN_HOT:
+		case TKN_IN:
+		case TKN_INTRINSIC:
+		case TKN_LABEL:
+		case TKN_NOINIT:
+		case TKN_NOINLINE:
+		case TKN_PACKED:
+		case TKN_PURE:
+		case TKN_REDUCE:
+		case TKN_RESTRICT:
+		case TKN_SHUFFLE:
+		case TKN_THREAD_LOCAL:
+		case TKN_UNCHECKED:
+		case TKN_UNROLL:
+		case TKN_VEC:
+		case TKN_VECTORIZE:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static unsigned
+find_action (const parser_state_t *state, int token) {
+	unsigned i;
+	for (i = 0; i < state->num_actions; ++i)
+		if (state->actions[i].token == token)
+			break;
+	return i;
+}
+
+/*
+ * Returns whether the parser in `state` can shift `token` and then continue
+ * with the token that follows it in `lex`. Reductions are assumed to be able
+ * to continue.
+ */
+static int
+can_continue_with (const parser_state_t *state, const lexer_t *lex, int token) {
+	unsigned i = find_action(state, token);
+	if (i >= state->num_actions)
+		return 0;
+	if (state->actions[i].state_or_length < 0)
+		return 1;
+	lexer_t peek = *lex;
+	peek.token = token;
+	lexer_next(&peek);
+	const parser_state_t *next = parser_states + state->actions[i].state_or_length;
+	if (find_action(next, peek.token) < next->num_actions)
+		return 1;
+	return is_soft_keyword(peek.token) && find_action(next, TKN_IDENT) < next->num_actions;
+}
+
+
 array_t *
 parse (lexer_t *lex) {
 	unsigned i;
@@ -30,9 +96,11 @@ parse (lexer_t *lex) {
 		parser_stack_t *current = array_get(&stack, stack.size-1);
 		const parser_state_t *state = parser_states + current->state;
 
-		for (i = 0; i < state->num_actions; ++i)
-			if (state->actions[i].token == lex->token)
-				break;
+		if (is_soft_keyword(lex->token) &&
+		    !can_continue_with(state, lex, lex->token) &&
+		    can_continue_with(state, lex, TKN_IDENT))
+			lex->token = TKN_IDENT;
+		i = find_action(state, lex->token);
 
 		if (i >= state->num_actions) {
 			char *msg = strdup("syntax error, expected");
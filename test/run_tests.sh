@@ -61,8 +61,11 @@ find $DIR -name "*.low" -print0 | while read -d $'\0' TEST; do
 		ALSO="$ALSO $TEST_DIR/$f"
 	done
 
+	# determine what additional options need to be passed to the compiler
+	FLAGS=$(grep -oh -m 1 "+flags .*" "$TEST" | cut -c8- || true)
+
 	# compile the program
-	if "$LOWC" "$TEST" $ALSO -o "$TEST_OUT" 1>.out 2>&1; then
+	if "$LOWC" $FLAGS "$TEST" $ALSO -o "$TEST_OUT" 1>.out 2>&1; then
 		if [ $COMP_FAIL = 1 ]; then
 			log_fail "$TEST_NAME"
 			printf "        compilation succeeded, but should have failed\n"
@@ -79,6 +82,25 @@ find $DIR -name "*.low" -print0 | while read -d $'\0' TEST; do
 		fi
 	fi
 
+	# check the emitted IR for patterns that must (+ir) or must not (-ir) appear
+	IR_FAIL=
+	while read -r LINE; do
+		PATTERN=${LINE:4}
+		if [ "${LINE:0:1}" = "+" ] && ! grep -qE -- "$PATTERN" "$TEST_OUT"; then
+			IR_FAIL="IR lacks '$PATTERN'"
+			break
+		fi
+		if [ "${LINE:0:1}" = "-" ] && grep -qE -- "$PATTERN" "$TEST_OUT"; then
+			IR_FAIL="IR contains '$PATTERN'"
+			break
+		fi
+	done < <(grep -oh "^// [+-]ir .*" "$TEST" | cut -c4- || true)
+	if [ -n "$IR_FAIL" ]; then
+		log_fail "$TEST_NAME"
+		printf "        %s\n" "$IR_FAIL"
+		continue
+	fi
+
 	# execute the program if configured that way
 	if [ $EXEC_PASS == 1 ] || [ $EXEC_FAIL == 1 ]; then
 		if "$LLI" "$TEST_OUT" 1>.out 2>&1; then